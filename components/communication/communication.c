@@ -2,15 +2,27 @@
 #include "communication.h"
 #include "esp_log.h"
 #include "mqtt_client.h"
-#include "cJSON.h"
 #include "esp_tls.h"
 #include "esp_mac.h"
+#include "esp_timer.h"
+#include "perf_stats.h"
+#include "power_management.h"
+#include "resource_monitor.h"
+#include "task_topology.h"
 #include <stdio.h>
 
 static const char *TAG = "COMMUNICATION";
+
+#define TELEMETRY_PERF_REPORT_CYCLES 60
+#define COMMAND_PERF_REPORT_COUNT 16
+
 static esp_mqtt_client_handle_t mqtt_client;
 static QueueHandle_t command_queue_handle;
 static QueueHandle_t telemetry_queue_handle;
+static perf_stats_t encode_stats = PERF_STATS_INIT("telemetry_encode");
+static perf_stats_t decode_stats = PERF_STATS_INIT("command_decode"); // Only touched by the MQTT task
+static int commands_since_report;
+static char telemetry_json[TELEMETRY_JSON_MAX_LEN];
 
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data) {
     ESP_LOGD(TAG, "Event dispatched from event loop base=%s, event_id=%d", base, event_id);
@@ -35,25 +47,25 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     case MQTT_EVENT_PUBLISHED:
         ESP_LOGI(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
         break;
-    case MQTT_EVENT_DATA:
+    case MQTT_EVENT_DATA: {
         ESP_LOGI(TAG, "MQTT_EVENT_DATA, TOPIC=%.*s DATA=%.*s", event->topic_len, event->topic, event->data_len, event->data);
-        cJSON *json = cJSON_Parse(event->data);
-        if (json != NULL) {
-            command_t command;
-            cJSON *command_id_json = cJSON_GetObjectItem(json, "command_id");
-            if (cJSON_IsNumber(command_id_json)) {
-                command.command_id = command_id_json->valueint;
-                if (xQueueSend(command_queue_handle, &command, 0) != pdTRUE) {
-                    ESP_LOGW(TAG, "Failed to send command to queue");
-                }
-            } else {
-                ESP_LOGW(TAG, "Invalid command format");
+        command_t command;
+        int64_t t0 = esp_timer_get_time();
+        bool valid = command_decode(event->data, event->data_len, &command);
+        perf_stats_record(&decode_stats, (uint32_t)(esp_timer_get_time() - t0));
+        if (valid) {
+            if (xQueueSend(command_queue_handle, &command, 0) != pdTRUE) {
+                ESP_LOGW(TAG, "Failed to send command to queue");
             }
-            cJSON_Delete(json);
         } else {
-            ESP_LOGW(TAG, "Failed to parse JSON command");
+            ESP_LOGW(TAG, "Invalid command format");
+        }
+        if (++commands_since_report >= COMMAND_PERF_REPORT_COUNT) {
+            perf_stats_report(&decode_stats);
+            commands_since_report = 0;
         }
         break;
+    }
     case MQTT_EVENT_ERROR:
         ESP_LOGI(TAG, "MQTT_EVENT_ERROR");
         if (event->error_handle->error_type == MQTT_ERROR_TYPE_TCP_TRANSPORT) {
@@ -90,18 +102,15 @@ esp_err_t communication_init(QueueHandle_t command_queue, QueueHandle_t telemetr
 esp_err_t send_telemetry(const telemetry_data_t *data) {
     if (!mqtt_client) return ESP_FAIL;
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddNumberToObject(json, "battery_voltage", data->battery_voltage);
-    cJSON_AddNumberToObject(json, "cpu_load", data->cpu_load);
-    char *json_str = cJSON_PrintUnformatted(json);
-    if (json_str != NULL) {
-        int msg_id = esp_mqtt_client_publish(mqtt_client, "/drone/telemetry", json_str, 1, 0, 0); // QoS 1 for reliability
-        ESP_LOGI(TAG, "sent publish successful, msg_id=%d, data=%s", msg_id, json_str);
-        free(json_str);
-    } else {
+    int64_t t0 = esp_timer_get_time();
+    int len = telemetry_encode(data, telemetry_json, sizeof(telemetry_json));
+    perf_stats_record(&encode_stats, (uint32_t)(esp_timer_get_time() - t0));
+    if (len < 0) {
         ESP_LOGE(TAG, "Failed to serialize telemetry data to JSON");
+        return ESP_FAIL;
     }
-    cJSON_Delete(json);
+    int msg_id = esp_mqtt_client_publish(mqtt_client, "/drone/telemetry", telemetry_json, len, 1, 0); // QoS 1 for reliability
+    ESP_LOGI(TAG, "sent publish successful, msg_id=%d, data=%s", msg_id, telemetry_json);
     return ESP_OK;
 }
 
@@ -114,12 +123,20 @@ esp_err_t receive_command(command_t *command) {
 
 void communication_task(void *pvParameters) {
     telemetry_data_t telemetry;
+    int cycles_since_report = 0;
     while (1) {
-        // Example telemetry data
-        telemetry.battery_voltage = 12.34f;
-        telemetry.cpu_load = 0.5f; // Example CPU load
+        task_monitor_begin();
+        telemetry.battery_voltage = power_management_get_battery_voltage();
+        resource_monitor_get_core_load(telemetry.core_load);
+        telemetry.cpu_load = (telemetry.core_load[0] + telemetry.core_load[1]) / 2.0f;
+        telemetry.min_stack_free = resource_monitor_get_min_stack_free();
+        telemetry.deadline_misses = task_monitor_total_misses();
         send_telemetry(&telemetry);
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        if (++cycles_since_report >= TELEMETRY_PERF_REPORT_CYCLES) {
+            perf_stats_report(&encode_stats);
+            cycles_since_report = 0;
+        }
+        task_monitor_delay(power_management_get_rates().telemetry_period_ms);
     }
     vTaskDelete(NULL);
 }
@@ -4,17 +4,7 @@
 
 #include <freertos/FreeRTOS.h>
 #include <stdint.h>
-
-typedef struct {
-    int command_id;
-    // Add specific command parameters
-} command_t;
-
-typedef struct {
-    float battery_voltage;
-    float cpu_load;
-    // Add other relevant telemetry data
-} telemetry_data_t;
+#include "telemetry_codec.h"
 
 esp_err_t communication_init(QueueHandle_t command_queue, QueueHandle_t telemetry_queue);
 void communication_task(void *pvParameters);
@@ -0,0 +1,34 @@
+// components/communication/telemetry_codec.c
+#include "telemetry_codec.h"
+#include "cJSON.h"
+#include <string.h>
+
+int telemetry_encode(const telemetry_data_t *data, char *buf, size_t len) {
+    cJSON *json = cJSON_CreateObject();
+    if (!json) {
+        return -1;
+    }
+    cJSON_AddNumberToObject(json, "battery_voltage", data->battery_voltage);
+    cJSON_AddNumberToObject(json, "cpu_load", data->cpu_load);
+    cJSON_AddNumberToObject(json, "core0_load", data->core_load[0]);
+    cJSON_AddNumberToObject(json, "core1_load", data->core_load[1]);
+    cJSON_AddNumberToObject(json, "min_stack_free", data->min_stack_free);
+    cJSON_AddNumberToObject(json, "deadline_misses", data->deadline_misses);
+    bool printed = cJSON_PrintPreallocated(json, buf, (int)len, false);
+    cJSON_Delete(json);
+    return printed ? (int)strlen(buf) : -1;
+}
+
+bool command_decode(const char *json, size_t len, command_t *command) {
+    cJSON *root = cJSON_ParseWithLength(json, len);
+    if (!root) {
+        return false;
+    }
+    cJSON *command_id = cJSON_GetObjectItem(root, "command_id");
+    bool valid = cJSON_IsNumber(command_id);
+    if (valid) {
+        command->command_id = command_id->valueint;
+    }
+    cJSON_Delete(root);
+    return valid;
+}
@@ -0,0 +1,35 @@
+// components/communication/telemetry_codec.h
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// JSON encoding of telemetry and decoding of ground commands, both through
+// cJSON. Telemetry is printed into a caller buffer.
+
+#define TELEMETRY_JSON_MAX_LEN 256     // cJSON_PrintPreallocated wants 5 bytes of slack
+
+typedef struct {
+    int command_id;
+    // Add specific command parameters
+} command_t;
+
+typedef struct {
+    float battery_voltage;
+    float cpu_load;          // Mean of the per-core loads
+    float core_load[2];      // Busy fraction of PRO_CPU and APP_CPU
+    uint32_t min_stack_free; // Smallest stack high-water mark across tasks, bytes
+    uint32_t deadline_misses; // Periodic task cycles that overran their deadline since boot
+    // Add other relevant telemetry data
+} telemetry_data_t;
+
+// Returns the JSON length, or -1 if it does not fit in len bytes
+int telemetry_encode(const telemetry_data_t *data, char *buf, size_t len);
+// Parses a command object such as {"command_id": 3}. The input need not be
+// null-terminated. Returns false if it is malformed or command_id is not a
+// number; a fractional id is truncated and the first of duplicate keys wins.
+bool command_decode(const char *json, size_t len, command_t *command);
+
+#endif // TELEMETRY_CODEC_H
@@ -0,0 +1,25 @@
+// components/frame_arena/frame_arena.c
+#include "frame_arena.h"
+
+void frame_arena_init(frame_arena_t *arena, uint8_t *buffer, size_t size) {
+    arena->base = buffer;
+    arena->size = size;
+    arena->used = 0;
+    arena->high_water = 0;
+}
+
+void *frame_arena_alloc(frame_arena_t *arena, size_t size) {
+    size_t offset = (arena->used + FRAME_ARENA_ALIGN - 1) & ~(size_t)(FRAME_ARENA_ALIGN - 1);
+    if (offset > arena->size || size > arena->size - offset) {
+        return NULL;
+    }
+    arena->used = offset + size;
+    if (arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+    return arena->base + offset;
+}
+
+void frame_arena_reset(frame_arena_t *arena) {
+    arena->used = 0;
+}
@@ -0,0 +1,24 @@
+// components/frame_arena/frame_arena.h
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_ARENA_ALIGN 8
+
+// Bump allocator for per-frame scratch memory. The backing buffer is owned by
+// the caller (static, placed in internal RAM or PSRAM); nothing is freed
+// individually, the whole arena is reset at the start of each frame.
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    size_t high_water;
+} frame_arena_t;
+
+void frame_arena_init(frame_arena_t *arena, uint8_t *buffer, size_t size);
+void *frame_arena_alloc(frame_arena_t *arena, size_t size);
+void frame_arena_reset(frame_arena_t *arena);
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,142 @@
+// components/i2c_bus/i2c_bus.c
+#include "i2c_bus.h"
+#include "esp_log.h"
+#include "perf_stats.h"
+#include <freertos/queue.h>
+#include <esp_timer.h>
+
+static const char *TAG = "I2C_BUS";
+
+#define I2C_BUS_OP_TIMEOUT_MS 10
+#define I2C_BUS_REPORT_TRANSACTIONS 256
+
+static i2c_port_t bus_port;
+static SemaphoreHandle_t bus_mutex;
+static i2c_bus_core_t core;
+
+// The bus task is the only owner of the port; clients hand it transactions
+// through one queue per priority class. work_sem counts queued transactions
+// so the task can block on both queues at once.
+static QueueHandle_t txn_queues[I2C_BUS_PRIO_COUNT];
+static SemaphoreHandle_t work_sem;
+static uint8_t high_queue_storage[I2C_BUS_HIGH_QUEUE_LEN * sizeof(i2c_bus_transaction_t)];
+static uint8_t low_queue_storage[I2C_BUS_LOW_QUEUE_LEN * sizeof(i2c_bus_transaction_t)];
+static StaticQueue_t queue_structs[I2C_BUS_PRIO_COUNT];
+static StaticSemaphore_t work_sem_buffer;
+
+// Queueing latency per priority class, submit to start of execution
+static perf_stats_t latency_stats[I2C_BUS_PRIO_COUNT] = {
+    PERF_STATS_INIT("i2c_queue_high"),
+    PERF_STATS_INIT("i2c_queue_low"),
+};
+
+static const i2c_bus_port_t freertos_port;
+
+esp_err_t i2c_bus_init(i2c_port_t port, SemaphoreHandle_t mutex) {
+    if (!mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    bus_port = port;
+    bus_mutex = mutex;
+    i2c_bus_core_init(&core, &freertos_port);
+    txn_queues[I2C_BUS_PRIO_HIGH] = xQueueCreateStatic(I2C_BUS_HIGH_QUEUE_LEN, sizeof(i2c_bus_transaction_t),
+                                                       high_queue_storage, &queue_structs[I2C_BUS_PRIO_HIGH]);
+    txn_queues[I2C_BUS_PRIO_LOW] = xQueueCreateStatic(I2C_BUS_LOW_QUEUE_LEN, sizeof(i2c_bus_transaction_t),
+                                                      low_queue_storage, &queue_structs[I2C_BUS_PRIO_LOW]);
+    work_sem = xSemaphoreCreateCountingStatic(I2C_BUS_HIGH_QUEUE_LEN + I2C_BUS_LOW_QUEUE_LEN, 0, &work_sem_buffer);
+    if (!txn_queues[I2C_BUS_PRIO_HIGH] || !txn_queues[I2C_BUS_PRIO_LOW] || !work_sem) {
+        ESP_LOGE(TAG, "Failed to create I2C bus queues");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_submit(const i2c_bus_transaction_t *txn, TickType_t timeout) {
+    if (!i2c_bus_core_valid(txn)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!i2c_bus_core_claim_key(&core, txn->coalesce_key)) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    i2c_bus_transaction_t queued = *txn;
+    queued.submit_time_us = esp_timer_get_time();
+    if (xQueueSend(txn_queues[txn->priority], &queued, timeout) != pdTRUE) {
+        i2c_bus_core_drop_key(&core, txn->coalesce_key);
+        ESP_LOGW(TAG, "I2C %s priority queue full", txn->priority == I2C_BUS_PRIO_HIGH ? "high" : "low");
+        return ESP_ERR_TIMEOUT;
+    }
+    xSemaphoreGive(work_sem);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_wait(TickType_t timeout) {
+    uint32_t value;
+    if (xTaskNotifyWait(0, UINT32_MAX, &value, timeout) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return (esp_err_t)value;
+}
+
+static bool receive(i2c_bus_priority_t priority, i2c_bus_transaction_t *txn) {
+    return xQueueReceive(txn_queues[priority], txn, 0) == pdTRUE;
+}
+
+static int execute_op(const i2c_bus_op_t *op) {
+    TickType_t ticks = pdMS_TO_TICKS(I2C_BUS_OP_TIMEOUT_MS);
+    esp_err_t result;
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
+    if (op->write_len && op->read_len) {
+        result = i2c_master_write_read_device(bus_port, op->addr, op->write_buf, op->write_len, op->read_buf, op->read_len, ticks);
+    } else if (op->write_len) {
+        result = i2c_master_write_to_device(bus_port, op->addr, op->write_buf, op->write_len, ticks);
+    } else {
+        result = i2c_master_read_from_device(bus_port, op->addr, op->read_buf, op->read_len, ticks);
+    }
+    xSemaphoreGive(bus_mutex);
+    return result;
+}
+
+static void started(const i2c_bus_transaction_t *txn) {
+    perf_stats_record(&latency_stats[txn->priority], (uint32_t)(esp_timer_get_time() - txn->submit_time_us));
+}
+
+static void complete(const i2c_bus_transaction_t *txn, int result) {
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "I2C transaction failed: %s", esp_err_to_name(result));
+    }
+    if (txn->notify_task) {
+        xTaskNotify((TaskHandle_t)txn->notify_task, (uint32_t)result, eSetValueWithOverwrite);
+    }
+    if (txn->callback) {
+        txn->callback(result, txn->callback_arg);
+    }
+}
+
+static const i2c_bus_port_t freertos_port = {
+    .receive = receive,
+    .execute_op = execute_op,
+    .started = started,
+    .complete = complete,
+};
+
+void i2c_bus_task(void *pvParameters) {
+    int transactions_since_report = 0;
+
+    while (1) {
+        xSemaphoreTake(work_sem, portMAX_DELAY);
+
+        // A high-priority item may already have been run between the ops of
+        // a low-priority list, in which case both queues can be empty here.
+        if (!i2c_bus_core_run_next(&core)) {
+            continue;
+        }
+
+        if (++transactions_since_report >= I2C_BUS_REPORT_TRANSACTIONS) {
+            perf_stats_report(&latency_stats[I2C_BUS_PRIO_HIGH]);
+            perf_stats_report(&latency_stats[I2C_BUS_PRIO_LOW]);
+            transactions_since_report = 0;
+        }
+    }
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,25 @@
+// components/i2c_bus/i2c_bus.h
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <driver/i2c.h>
+#include <stdint.h>
+#include "i2c_bus_core.h"
+
+// bus_mutex is the port's existing i2c_mutex. The bus task holds it for each
+// operation so drivers that still talk to the port directly, such as
+// magnet_control, stay serialized with it.
+esp_err_t i2c_bus_init(i2c_port_t port, SemaphoreHandle_t bus_mutex);
+void i2c_bus_task(void *pvParameters);
+// Queues a transaction without blocking on the bus. Returns
+// ESP_ERR_NOT_FINISHED when it was coalesced into an already queued
+// transaction with the same key: no completion is signalled for it and the
+// caller must not wait; the queued read delivers the fresh data.
+esp_err_t i2c_bus_submit(const i2c_bus_transaction_t *txn, TickType_t timeout);
+// Blocks the calling task until a transaction submitted with notify_task set completes
+esp_err_t i2c_bus_wait(TickType_t timeout);
+
+#endif // I2C_BUS_H
@@ -0,0 +1,61 @@
+// components/i2c_bus/i2c_bus_core.c
+#include "i2c_bus_core.h"
+
+void i2c_bus_core_init(i2c_bus_core_t *core, const i2c_bus_port_t *port) {
+    core->port = port;
+    atomic_init(&core->pending_keys, 0);
+}
+
+bool i2c_bus_core_valid(const i2c_bus_transaction_t *txn) {
+    return txn->op_count > 0 && txn->op_count <= I2C_BUS_MAX_OPS && txn->priority < I2C_BUS_PRIO_COUNT &&
+           txn->coalesce_key <= I2C_BUS_MAX_COALESCE_KEY;
+}
+
+bool i2c_bus_core_claim_key(i2c_bus_core_t *core, uint8_t key) {
+    if (!key) {
+        return true;
+    }
+    uint_fast32_t bit = (uint_fast32_t)1 << key;
+    return (atomic_fetch_or(&core->pending_keys, bit) & bit) == 0;
+}
+
+void i2c_bus_core_drop_key(i2c_bus_core_t *core, uint8_t key) {
+    if (key) {
+        atomic_fetch_and(&core->pending_keys, ~((uint_fast32_t)1 << key));
+    }
+}
+
+static void run_transaction(i2c_bus_core_t *core, const i2c_bus_transaction_t *txn);
+
+// Runs every queued high-priority transaction. Called between the operations
+// of a low-priority list so a magnet command waits at most one operation.
+static void run_high_priority(i2c_bus_core_t *core) {
+    i2c_bus_transaction_t txn;
+    while (core->port->receive(I2C_BUS_PRIO_HIGH, &txn)) {
+        run_transaction(core, &txn);
+    }
+}
+
+static void run_transaction(i2c_bus_core_t *core, const i2c_bus_transaction_t *txn) {
+    core->port->started(txn);
+    // From here on a new submission with the same key needs a fresh read
+    i2c_bus_core_drop_key(core, txn->coalesce_key);
+
+    int result = 0;
+    for (int i = 0; i < txn->op_count && result == 0; i++) {
+        if (i > 0 && txn->priority != I2C_BUS_PRIO_HIGH) {
+            run_high_priority(core);
+        }
+        result = core->port->execute_op(&txn->ops[i]);
+    }
+    core->port->complete(txn, result);
+}
+
+bool i2c_bus_core_run_next(i2c_bus_core_t *core) {
+    i2c_bus_transaction_t txn;
+    if (!core->port->receive(I2C_BUS_PRIO_HIGH, &txn) && !core->port->receive(I2C_BUS_PRIO_LOW, &txn)) {
+        return false;
+    }
+    run_transaction(core, &txn);
+    return true;
+}
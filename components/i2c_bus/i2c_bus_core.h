@@ -0,0 +1,72 @@
+// components/i2c_bus/i2c_bus_core.h
+#ifndef I2C_BUS_CORE_H
+#define I2C_BUS_CORE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Dispatch logic of the bus manager: priority order, preemption between ops
+// and coalescing. The bus task feeds it requests and runs the ops it picks.
+
+#define I2C_BUS_MAX_OPS 4          // Operations per transaction list
+#define I2C_BUS_HIGH_QUEUE_LEN 4
+#define I2C_BUS_LOW_QUEUE_LEN 8
+#define I2C_BUS_MAX_COALESCE_KEY 31
+
+typedef enum {
+    I2C_BUS_PRIO_HIGH,             // Safety-critical commands, e.g. magnet release
+    I2C_BUS_PRIO_LOW,              // Housekeeping and periodic sensor reads
+    I2C_BUS_PRIO_COUNT
+} i2c_bus_priority_t;
+
+// One device access: write, read, or write-then-read with a repeated start
+typedef struct {
+    uint8_t addr;
+    const uint8_t *write_buf;
+    size_t write_len;
+    uint8_t *read_buf;
+    size_t read_len;
+} i2c_bus_op_t;
+
+typedef void (*i2c_bus_callback_t)(int result, void *arg);   // result is an esp_err_t
+
+// Prebuilt transaction list, executed back to back by the bus task. Buffers
+// referenced by the ops must stay valid until completion is signalled.
+typedef struct {
+    i2c_bus_op_t ops[I2C_BUS_MAX_OPS];
+    uint8_t op_count;
+    i2c_bus_priority_t priority;
+    uint8_t coalesce_key;          // 1..31: skip if the same periodic read is still queued
+    void *notify_task;             // TaskHandle_t notified with the result, or NULL
+    i2c_bus_callback_t callback;   // Called from the bus task, or NULL
+    void *callback_arg;
+    int64_t submit_time_us;        // Set on submission
+} i2c_bus_transaction_t;
+
+// Platform side of the bus: queues, the driver and completion signalling
+typedef struct {
+    bool (*receive)(i2c_bus_priority_t priority, i2c_bus_transaction_t *txn);  // Non-blocking
+    int (*execute_op)(const i2c_bus_op_t *op);                                 // 0 on success
+    void (*started)(const i2c_bus_transaction_t *txn);                         // Leaves the queue
+    void (*complete)(const i2c_bus_transaction_t *txn, int result);
+} i2c_bus_port_t;
+
+typedef struct {
+    const i2c_bus_port_t *port;
+    atomic_uint_fast32_t pending_keys;   // Coalescing keys of periodic reads still queued
+} i2c_bus_core_t;
+
+void i2c_bus_core_init(i2c_bus_core_t *core, const i2c_bus_port_t *port);
+bool i2c_bus_core_valid(const i2c_bus_transaction_t *txn);
+// False when a transaction with the same key is still queued and this one
+// should be folded into it. Undo with i2c_bus_core_drop_key() if queueing fails.
+bool i2c_bus_core_claim_key(i2c_bus_core_t *core, uint8_t key);
+void i2c_bus_core_drop_key(i2c_bus_core_t *core, uint8_t key);
+// Takes the next transaction, high priority first, and runs it. High-priority
+// transactions that arrive meanwhile run between the ops of a low-priority
+// list. Returns false when both queues were empty.
+bool i2c_bus_core_run_next(i2c_bus_core_t *core);
+
+#endif // I2C_BUS_CORE_H
@@ -0,0 +1,31 @@
+// components/jpeg_gray/gray_sample.c
+#include "gray_sample.h"
+
+int gray_sample_scale(int src_width, int src_height, int out_width, int out_height) {
+    int scale = 0;
+    while (scale < 3 && (src_width >> (scale + 1)) >= out_width && (src_height >> (scale + 1)) >= out_height) {
+        scale++;
+    }
+    return scale;
+}
+
+void gray_sample_rgb_block(uint8_t *out, int out_width, int out_height, const uint8_t *rgb,
+                           int left, int top, int width, int height, int src_width, int src_height) {
+    // Output pixel (x, y) samples source pixel (x * src_width / out_width, ...)
+    int y = (top * out_height + src_height - 1) / src_height;
+    for (; y < out_height; y++) {
+        int src_y = y * src_height / out_height;
+        if (src_y >= top + height) {
+            break;
+        }
+        int x = (left * out_width + src_width - 1) / src_width;
+        for (; x < out_width; x++) {
+            int src_x = x * src_width / out_width;
+            if (src_x >= left + width) {
+                break;
+            }
+            const uint8_t *p = &rgb[((src_y - top) * width + (src_x - left)) * 3];
+            out[y * out_width + x] = (uint8_t)((p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8);
+        }
+    }
+}
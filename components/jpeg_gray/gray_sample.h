@@ -0,0 +1,18 @@
+// components/jpeg_gray/gray_sample.h
+#ifndef GRAY_SAMPLE_H
+#define GRAY_SAMPLE_H
+
+#include <stdint.h>
+
+// Nearest-neighbour sampling of decoded JPEG blocks into a smaller grayscale
+// plane, converting each sampled pixel with BT.601 luma weights.
+
+// Largest decoder scale (output is 1/2^scale of the frame, 0..3) that still
+// covers an out_width x out_height plane
+int gray_sample_scale(int src_width, int src_height, int out_width, int out_height);
+// Copies the pixels of one RGB888 block that land on the output grid into out.
+// The block sits at (left, top) in a src_width x src_height image.
+void gray_sample_rgb_block(uint8_t *out, int out_width, int out_height, const uint8_t *rgb,
+                           int left, int top, int width, int height, int src_width, int src_height);
+
+#endif // GRAY_SAMPLE_H
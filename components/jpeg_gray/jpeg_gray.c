@@ -0,0 +1,62 @@
+// components/jpeg_gray/jpeg_gray.c
+#include "jpeg_gray.h"
+#include "gray_sample.h"
+#include "esp_log.h"
+#include <string.h>
+#include "esp32s3/rom/tjpgd.h" // ROM JPEG decoder, works from a caller-supplied pool
+
+static const char *TAG = "JPEG_GRAY";
+
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+    int width, height;          // Decoded image size after scaling
+    uint8_t *out;
+    int out_width, out_height;
+} jpeg_gray_source_t;
+
+static uint32_t jpeg_gray_read(JDEC *jd, uint8_t *buf, uint32_t len) {
+    jpeg_gray_source_t *src = (jpeg_gray_source_t *)jd->device;
+    if (len > src->len - src->pos) {
+        len = src->len - src->pos;
+    }
+    if (buf) {
+        memcpy(buf, src->data + src->pos, len);
+    }
+    src->pos += len;
+    return len;
+}
+
+static uint32_t jpeg_gray_write(JDEC *jd, void *bitmap, JRECT *rect) {
+    jpeg_gray_source_t *src = (jpeg_gray_source_t *)jd->device;
+    gray_sample_rgb_block(src->out, src->out_width, src->out_height, (const uint8_t *)bitmap, rect->left, rect->top,
+                          rect->right - rect->left + 1, rect->bottom - rect->top + 1, src->width, src->height);
+    return 1;
+}
+
+esp_err_t jpeg_gray_decode(const uint8_t *jpeg, size_t len, void *pool, uint8_t *out, int out_width, int out_height) {
+    jpeg_gray_source_t src = {
+        .data = jpeg, .len = len, .out = out, .out_width = out_width, .out_height = out_height,
+    };
+    JDEC jd;
+    JRESULT res = jd_prepare(&jd, jpeg_gray_read, pool, JPEG_GRAY_WORKSPACE, &src);
+    if (res != JDR_OK) {
+        ESP_LOGE(TAG, "JPEG header parsing failed (%d)", res);
+        return ESP_FAIL;
+    }
+    if (jd.width < out_width || jd.height < out_height) {
+        ESP_LOGE(TAG, "JPEG %dx%d is smaller than the %dx%d output", jd.width, jd.height, out_width, out_height);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int scale = gray_sample_scale(jd.width, jd.height, out_width, out_height);
+    src.width = (jd.width + (1 << scale) - 1) >> scale;
+    src.height = (jd.height + (1 << scale) - 1) >> scale;
+    res = jd_decomp(&jd, jpeg_gray_write, scale);
+    if (res != JDR_OK) {
+        ESP_LOGE(TAG, "JPEG decoding failed (%d)", res);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
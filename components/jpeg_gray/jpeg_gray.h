@@ -0,0 +1,17 @@
+// components/jpeg_gray/jpeg_gray.h
+#ifndef JPEG_GRAY_H
+#define JPEG_GRAY_H
+
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define JPEG_GRAY_WORKSPACE 3100  // Decoder work pool, the same for every frame size
+
+// Decodes a JPEG into an out_width x out_height grayscale plane. The decoder
+// drops resolution in the IDCT where it can and the rest is nearest-neighbour
+// sampled, so no full-resolution buffer is needed. pool is caller-owned
+// scratch of JPEG_GRAY_WORKSPACE bytes; nothing is allocated.
+esp_err_t jpeg_gray_decode(const uint8_t *jpeg, size_t len, void *pool, uint8_t *out, int out_width, int out_height);
+
+#endif // JPEG_GRAY_H
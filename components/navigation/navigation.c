@@ -2,6 +2,7 @@
 #include "esp_log.h"
 #include "ultrasonic.h"
 #include "visual_odometry.h"
+#include "task_topology.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 
@@ -20,6 +21,7 @@ void navigation_task(void *pvParameters) {
     vo_data_t vo_data;
 
     while (1) {
+        task_monitor_begin();
         // Process ultrasonic data
         if (xQueueReceive(ultrasonic_queue_handle, &ultrasonic_data, pdMS_TO_TICKS(10)) == pdTRUE) {
             ESP_LOGI(TAG, "Received ultrasonic data: ID=%d, Distance=%.2f cm", ultrasonic_data.id, ultrasonic_data.distance_cm);
@@ -32,7 +34,7 @@ void navigation_task(void *pvParameters) {
             // Integrate VO data into navigation logic (e.g., update position estimate)
         }
 
-        vTaskDelay(pdMS_TO_TICKS(10));
+        task_monitor_delay(10);
     }
     vTaskDelete(NULL);
 }
@@ -0,0 +1,343 @@
+// components/ota_update/delta_patch.c
+#include "delta_patch.h"
+#include <string.h>
+
+enum {
+    STATE_HEADER,
+    STATE_TAG,
+    STATE_LENGTH,
+    STATE_OFFSET,
+    STATE_INSERT,
+    STATE_DIFF,
+};
+
+enum {
+    LZ_CONTROL,
+    LZ_LITERAL,
+    LZ_DISTANCE,
+};
+
+static uint32_t read_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void delta_patch_init(delta_patch_t *patch, delta_read_fn read, delta_write_fn write, delta_begin_fn begin, void *ctx) {
+    memset(patch, 0, sizeof(*patch));
+    patch->read = read;
+    patch->write = write;
+    patch->begin = begin;
+    patch->ctx = ctx;
+    patch->state = STATE_HEADER;
+    patch->lz_state = LZ_CONTROL;
+    mbedtls_sha256_init(&patch->sha);
+}
+
+void delta_patch_free(delta_patch_t *patch) {
+    mbedtls_sha256_free(&patch->sha);
+}
+
+// Returns 1 when the varint is complete, 0 if more bytes are needed, -1 on overflow
+static int push_varint_byte(uint64_t *value, int *shift, uint8_t byte) {
+    if (*shift > 56) {
+        return -1;
+    }
+    *value |= (uint64_t)(byte & 0x7f) << *shift;
+    *shift += 7;
+    return (byte & 0x80) ? 0 : 1;
+}
+
+static delta_status_t emit(delta_patch_t *patch, const uint8_t *buf, size_t len) {
+    if (patch->write(patch->ctx, buf, len) != 0) {
+        return DELTA_ERR_IO;
+    }
+    mbedtls_sha256_update(&patch->sha, buf, len);
+    patch->written += len;
+    return DELTA_OK;
+}
+
+// Hashes the source image through the copy window. Done before anything is
+// written, so a patch made against another build fails before the target
+// partition is erased.
+static delta_status_t verify_source(delta_patch_t *patch) {
+    mbedtls_sha256_starts(&patch->sha, 0);
+    for (uint32_t offset = 0; offset < patch->header.source_size; offset += DELTA_PATCH_WINDOW) {
+        uint32_t n = patch->header.source_size - offset;
+        n = n < DELTA_PATCH_WINDOW ? n : DELTA_PATCH_WINDOW;
+        if (patch->read(patch->ctx, offset, patch->window, n) != 0) {
+            return DELTA_ERR_IO;
+        }
+        mbedtls_sha256_update(&patch->sha, patch->window, n);
+    }
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&patch->sha, digest);
+    return memcmp(digest, patch->header.source_sha256, sizeof(digest)) == 0 ? DELTA_OK : DELTA_ERR_SOURCE;
+}
+
+static delta_status_t parse_header(delta_patch_t *patch) {
+    const uint8_t *h = patch->header_buf;
+    if (memcmp(h, DELTA_PATCH_MAGIC, 4) != 0 || h[4] < 2 || h[4] > DELTA_PATCH_VERSION) {
+        return DELTA_ERR_FORMAT;
+    }
+    patch->flags = h[5];
+    if ((patch->flags & ~DELTA_FLAG_LZ) != 0 || (h[4] < 3 && patch->flags != 0)) {
+        return DELTA_ERR_FORMAT;
+    }
+    patch->header.source_size = read_le32(h + 8);
+    patch->header.target_size = read_le32(h + 12);
+    memcpy(patch->header.target_sha256, h + 16, 32);
+    memcpy(patch->header.source_sha256, h + 48, 32);
+
+    delta_status_t status = verify_source(patch);
+    if (status == DELTA_OK && patch->begin) {
+        status = patch->begin(patch->ctx, &patch->header);
+    }
+    mbedtls_sha256_starts(&patch->sha, 0);
+    return status;
+}
+
+// Copies length bytes from the source image through the fixed window
+static delta_status_t copy_from_source(delta_patch_t *patch, uint32_t offset) {
+    while (patch->length > 0) {
+        size_t n = patch->length < DELTA_PATCH_WINDOW ? patch->length : DELTA_PATCH_WINDOW;
+        if (patch->read(patch->ctx, offset, patch->window, n) != 0) {
+            return DELTA_ERR_IO;
+        }
+        delta_status_t status = emit(patch, patch->window, n);
+        if (status != DELTA_OK) {
+            return status;
+        }
+        offset += n;
+        patch->length -= n;
+    }
+    return DELTA_OK;
+}
+
+// Adds difference bytes to the source window by window; each window is
+// written out once all of its bytes have their difference
+static size_t apply_diff(delta_patch_t *patch, const uint8_t *data, size_t len, delta_status_t *status) {
+    if (patch->diff_applied == patch->diff_loaded) {
+        uint32_t n = patch->length < DELTA_PATCH_WINDOW ? patch->length : DELTA_PATCH_WINDOW;
+        if (patch->read(patch->ctx, patch->diff_offset, patch->window, n) != 0) {
+            *status = DELTA_ERR_IO;
+            return 0;
+        }
+        patch->diff_offset += n;
+        patch->diff_loaded = n;
+        patch->diff_applied = 0;
+    }
+    size_t n = patch->diff_loaded - patch->diff_applied;
+    n = n < len ? n : len;
+    for (size_t i = 0; i < n; i++) {
+        patch->window[patch->diff_applied + i] += data[i];
+    }
+    patch->diff_applied += n;
+    if (patch->diff_applied == patch->diff_loaded) {
+        *status = emit(patch, patch->window, patch->diff_loaded);
+        patch->length -= patch->diff_loaded;
+        if (patch->length == 0) {
+            patch->state = STATE_TAG;
+        }
+    }
+    return n;
+}
+
+// Runs the (decompressed) command stream
+static delta_status_t run_commands(delta_patch_t *patch, const uint8_t *data, size_t len) {
+    delta_status_t status = DELTA_OK;
+
+    while (len > 0 && status == DELTA_OK) {
+        switch (patch->state) {
+        case STATE_TAG:
+            patch->tag = *data++;
+            len--;
+            if (patch->tag != DELTA_CMD_COPY && patch->tag != DELTA_CMD_INSERT && patch->tag != DELTA_CMD_DIFF) {
+                status = DELTA_ERR_FORMAT;
+                break;
+            }
+            patch->varint = 0;
+            patch->varint_shift = 0;
+            patch->state = STATE_LENGTH;
+            break;
+        case STATE_LENGTH: {
+            int done = push_varint_byte(&patch->varint, &patch->varint_shift, *data++);
+            len--;
+            if (done < 0) {
+                status = DELTA_ERR_FORMAT;
+            } else if (done) {
+                if (patch->varint == 0 || patch->varint > patch->header.target_size - patch->written) {
+                    status = DELTA_ERR_RANGE;
+                    break;
+                }
+                patch->length = (uint32_t)patch->varint;
+                patch->varint = 0;
+                patch->varint_shift = 0;
+                patch->state = patch->tag == DELTA_CMD_INSERT ? STATE_INSERT : STATE_OFFSET;
+            }
+            break;
+        }
+        case STATE_OFFSET: {
+            int done = push_varint_byte(&patch->varint, &patch->varint_shift, *data++);
+            len--;
+            if (done < 0) {
+                status = DELTA_ERR_FORMAT;
+            } else if (done) {
+                int64_t delta = (int64_t)(patch->varint >> 1) ^ -(int64_t)(patch->varint & 1);
+                int64_t offset = patch->source_pos + delta;
+                if (offset < 0 || offset + patch->length > patch->header.source_size) {
+                    status = DELTA_ERR_RANGE;
+                    break;
+                }
+                patch->source_pos = offset + patch->length;
+                if (patch->tag == DELTA_CMD_DIFF) {
+                    patch->diff_offset = (uint32_t)offset;
+                    patch->diff_loaded = 0;
+                    patch->diff_applied = 0;
+                    patch->state = STATE_DIFF;
+                } else {
+                    status = copy_from_source(patch, (uint32_t)offset);
+                    patch->state = STATE_TAG;
+                }
+            }
+            break;
+        }
+        case STATE_INSERT: {
+            // Literal bytes go straight from the input chunk to the output
+            size_t n = patch->length < len ? patch->length : len;
+            status = emit(patch, data, n);
+            data += n;
+            len -= n;
+            patch->length -= n;
+            if (patch->length == 0) {
+                patch->state = STATE_TAG;
+            }
+            break;
+        }
+        case STATE_DIFF: {
+            size_t n = apply_diff(patch, data, len, &status);
+            data += n;
+            len -= n;
+            break;
+        }
+        }
+    }
+    return status;
+}
+
+// Runs the last count decompressed bytes, which may wrap around the window
+static delta_status_t run_from_window(delta_patch_t *patch, uint32_t count) {
+    uint32_t start = (patch->lz_pos - count) & (DELTA_LZ_WINDOW - 1);
+    uint32_t first = DELTA_LZ_WINDOW - start < count ? DELTA_LZ_WINDOW - start : count;
+    delta_status_t status = run_commands(patch, patch->lz_window + start, first);
+    if (status == DELTA_OK && first < count) {
+        status = run_commands(patch, patch->lz_window, count - first);
+    }
+    return status;
+}
+
+// Decompresses the command stream into the window, running commands as
+// their bytes become available
+static delta_status_t inflate_commands(delta_patch_t *patch, const uint8_t *data, size_t len) {
+    delta_status_t status = DELTA_OK;
+
+    while (len > 0 && status == DELTA_OK) {
+        switch (patch->lz_state) {
+        case LZ_CONTROL: {
+            uint8_t control = *data++;
+            len--;
+            if (control & 0x80) {
+                patch->lz_count = (control & 0x7f) + DELTA_LZ_MIN_MATCH;
+                patch->lz_varint = 0;
+                patch->lz_varint_shift = 0;
+                patch->lz_state = LZ_DISTANCE;
+            } else {
+                patch->lz_count = control + 1;
+                patch->lz_state = LZ_LITERAL;
+            }
+            break;
+        }
+        case LZ_LITERAL: {
+            size_t n = patch->lz_count < len ? patch->lz_count : len;
+            for (size_t i = 0; i < n; i++) {
+                patch->lz_window[(patch->lz_pos + i) & (DELTA_LZ_WINDOW - 1)] = data[i];
+            }
+            patch->lz_pos += n;
+            status = run_commands(patch, data, n);
+            data += n;
+            len -= n;
+            patch->lz_count -= n;
+            if (patch->lz_count == 0) {
+                patch->lz_state = LZ_CONTROL;
+            }
+            break;
+        }
+        case LZ_DISTANCE: {
+            int done = push_varint_byte(&patch->lz_varint, &patch->lz_varint_shift, *data++);
+            len--;
+            if (done < 0) {
+                status = DELTA_ERR_FORMAT;
+            } else if (done) {
+                uint64_t distance = patch->lz_varint;
+                if (distance == 0 || distance > DELTA_LZ_WINDOW || distance > patch->lz_pos) {
+                    status = DELTA_ERR_FORMAT;
+                    break;
+                }
+                // Byte by byte, a match may overlap the bytes it produces
+                for (uint32_t i = 0; i < patch->lz_count; i++) {
+                    patch->lz_window[patch->lz_pos & (DELTA_LZ_WINDOW - 1)] =
+                        patch->lz_window[(patch->lz_pos - (uint32_t)distance) & (DELTA_LZ_WINDOW - 1)];
+                    patch->lz_pos++;
+                }
+                status = run_from_window(patch, patch->lz_count);
+                patch->lz_state = LZ_CONTROL;
+            }
+            break;
+        }
+        }
+    }
+    return status;
+}
+
+delta_status_t delta_patch_feed(delta_patch_t *patch, const uint8_t *data, size_t len) {
+    if (patch->state == STATE_HEADER) {
+        size_t n = DELTA_PATCH_HEADER_SIZE - patch->header_len;
+        n = n < len ? n : len;
+        memcpy(patch->header_buf + patch->header_len, data, n);
+        patch->header_len += n;
+        data += n;
+        len -= n;
+        if (patch->header_len < DELTA_PATCH_HEADER_SIZE) {
+            return DELTA_OK;
+        }
+        patch->state = STATE_TAG;
+        delta_status_t status = parse_header(patch);
+        if (status != DELTA_OK) {
+            return status;
+        }
+    }
+    return (patch->flags & DELTA_FLAG_LZ) ? inflate_commands(patch, data, len) : run_commands(patch, data, len);
+}
+
+delta_status_t delta_patch_finish(delta_patch_t *patch) {
+    if (patch->state != STATE_TAG || patch->lz_state != LZ_CONTROL || patch->written != patch->header.target_size) {
+        return DELTA_ERR_INCOMPLETE;
+    }
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&patch->sha, digest);
+    if (memcmp(digest, patch->header.target_sha256, sizeof(digest)) != 0) {
+        return DELTA_ERR_HASH;
+    }
+    return DELTA_OK;
+}
+
+const char *delta_status_str(delta_status_t status) {
+    switch (status) {
+    case DELTA_OK: return "ok";
+    case DELTA_ERR_FORMAT: return "malformed patch";
+    case DELTA_ERR_RANGE: return "command out of range";
+    case DELTA_ERR_IO: return "storage error";
+    case DELTA_ERR_INCOMPLETE: return "patch incomplete";
+    case DELTA_ERR_HASH: return "target hash mismatch";
+    case DELTA_ERR_SOURCE: return "source image mismatch";
+    }
+    return "unknown";
+}
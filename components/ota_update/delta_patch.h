@@ -0,0 +1,110 @@
+// components/ota_update/delta_patch.h
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mbedtls/sha256.h"
+
+// Streaming delta patch applier. Shared by the device OTA path and the host
+// tool, so it only talks to storage through the read/write callbacks.
+//
+// Patch layout, all integers little-endian:
+//   header   "DOTA", version, flags, 2 reserved bytes, source size (u32),
+//            target size (u32), SHA-256 of the target image,
+//            SHA-256 of the source image
+//   commands COPY   tag 0, length, source offset delta (zigzag), relative
+//                   to the end of the previous COPY or DIFF
+//            INSERT tag 1, length, literal bytes
+//            DIFF   tag 2, length, source offset delta as for COPY, then
+//                   length bytes added to the source bytes (mod 256), as
+//                   in bsdiff: code that moved keeps its instructions and
+//                   only its relocated addresses differ
+// Lengths and offsets are LEB128 varints. With DELTA_FLAG_LZ the commands
+// are compressed as a sequence of
+//   literal run  control 0x00-0x7f, then control + 1 bytes
+//   match        control 0x80-0xff, then the distance back (varint, at most
+//                DELTA_LZ_WINDOW); repeats control - 0x80 + DELTA_LZ_MIN_MATCH
+//                bytes of output
+// which turns the mostly-zero DIFF bytes into a few bytes per run.
+
+#define DELTA_PATCH_MAGIC "DOTA"
+#define DELTA_PATCH_VERSION 3        // Version 2 patches (no DIFF, no flags) are still applied
+#define DELTA_PATCH_HEADER_SIZE 80
+#define DELTA_PATCH_WINDOW 1024     // Source bytes buffered per COPY or DIFF step
+#define DELTA_LZ_WINDOW 4096        // Decompressed command bytes kept for matches, a power of two
+#define DELTA_LZ_MIN_MATCH 4
+
+#define DELTA_FLAG_LZ 0x01
+
+#define DELTA_CMD_COPY 0
+#define DELTA_CMD_INSERT 1
+#define DELTA_CMD_DIFF 2
+
+typedef enum {
+    DELTA_OK = 0,
+    DELTA_ERR_FORMAT,               // Malformed or unsupported patch
+    DELTA_ERR_RANGE,                // Command reads or writes out of bounds
+    DELTA_ERR_IO,                   // Read or write callback failed
+    DELTA_ERR_INCOMPLETE,           // Patch ended early
+    DELTA_ERR_HASH,                 // Output does not match the target hash
+    DELTA_ERR_SOURCE,               // Source image is not the one the patch was made against
+} delta_status_t;
+
+typedef struct {
+    uint32_t source_size;
+    uint32_t target_size;
+    uint8_t target_sha256[32];
+    uint8_t source_sha256[32];
+} delta_header_t;
+
+// Both return 0 on success
+typedef int (*delta_read_fn)(void *ctx, uint32_t offset, uint8_t *buf, size_t len);
+typedef int (*delta_write_fn)(void *ctx, const uint8_t *buf, size_t len);
+// Called once the header is parsed and the source image verified, before the
+// first write, so the caller can size and erase the target. Anything but
+// DELTA_OK stops the patch.
+typedef delta_status_t (*delta_begin_fn)(void *ctx, const delta_header_t *header);
+
+typedef struct {
+    delta_read_fn read;
+    delta_write_fn write;
+    delta_begin_fn begin;           // Optional
+    void *ctx;
+
+    delta_header_t header;
+    uint8_t header_buf[DELTA_PATCH_HEADER_SIZE];
+    size_t header_len;
+    uint8_t flags;
+
+    int state;
+    uint8_t tag;
+    uint64_t varint;                // Varint being decoded
+    int varint_shift;
+    uint32_t length;                // Remaining bytes of the current command
+    int64_t source_pos;             // End of the previous COPY or DIFF
+    uint32_t diff_offset;           // Next source byte to load for the DIFF
+    uint32_t diff_loaded;           // Source bytes in the window
+    uint32_t diff_applied;          // Of those, bytes the difference was added to
+    uint32_t written;
+
+    int lz_state;
+    uint32_t lz_count;              // Literal bytes left, or the match length
+    uint64_t lz_varint;
+    int lz_varint_shift;
+    uint32_t lz_pos;                // Decompressed bytes so far
+
+    mbedtls_sha256_context sha;
+    uint8_t window[DELTA_PATCH_WINDOW];
+    uint8_t lz_window[DELTA_LZ_WINDOW];
+} delta_patch_t;
+
+void delta_patch_init(delta_patch_t *patch, delta_read_fn read, delta_write_fn write, delta_begin_fn begin, void *ctx);
+// Feed the next chunk of patch data, any size
+delta_status_t delta_patch_feed(delta_patch_t *patch, const uint8_t *data, size_t len);
+// Checks the output is complete and matches the target hash
+delta_status_t delta_patch_finish(delta_patch_t *patch);
+void delta_patch_free(delta_patch_t *patch);
+const char *delta_status_str(delta_status_t status);
+
+#endif // DELTA_PATCH_H
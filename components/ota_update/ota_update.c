@@ -0,0 +1,200 @@
+// components/ota_update/ota_update.c
+#include "ota_update.h"
+#include "delta_patch.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_http_client.h"
+#include "esp_crt_bundle.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "OTA_UPDATE";
+
+#define OTA_HTTP_CHUNK 1024
+
+typedef struct {
+    const esp_partition_t *source;
+    const esp_partition_t *target;
+    esp_ota_handle_t ota_handle;
+    bool ota_begun;                 // Target erased and open for writing
+    delta_patch_t patch;
+    bool active;
+    int64_t start_us;
+    uint32_t patch_bytes;
+} delta_session_t;
+
+// Kept static: the patch state carries the copy window and hash context
+static delta_session_t session;
+
+esp_err_t ota_update_init() {
+    if (ota_update_pending_verify()) {
+        ESP_LOGI(TAG, "First boot of new image, rolled back on reset until confirmed healthy");
+    }
+    return ESP_OK;
+}
+
+bool ota_update_pending_verify(void) {
+    esp_ota_img_states_t state;
+    return esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) == ESP_OK &&
+           state == ESP_OTA_IMG_PENDING_VERIFY;
+}
+
+esp_err_t ota_update_confirm_image(bool healthy) {
+    if (!ota_update_pending_verify()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!healthy) {
+        ESP_LOGE(TAG, "New image failed its health check, rolling back");
+        return esp_ota_mark_app_invalid_rollback_and_reboot();
+    }
+    ESP_LOGI(TAG, "New image passed its health check, marking it valid");
+    return esp_ota_mark_app_valid_cancel_rollback();
+}
+
+static int read_source(void *ctx, uint32_t offset, uint8_t *buf, size_t len) {
+    delta_session_t *s = (delta_session_t *)ctx;
+    return esp_partition_read(s->source, offset, buf, len) == ESP_OK ? 0 : -1;
+}
+
+static int write_target(void *ctx, const uint8_t *buf, size_t len) {
+    delta_session_t *s = (delta_session_t *)ctx;
+    return esp_ota_write(s->ota_handle, buf, len) == ESP_OK ? 0 : -1;
+}
+
+// The source has been verified against the patch at this point; only now is
+// the target partition erased, and only as far as the new image needs
+static delta_status_t begin_target(void *ctx, const delta_header_t *header) {
+    delta_session_t *s = (delta_session_t *)ctx;
+    if (header->source_size > s->source->size || header->target_size > s->target->size) {
+        ESP_LOGE(TAG, "Patch does not fit the partitions");
+        return DELTA_ERR_RANGE;
+    }
+    esp_err_t ret = esp_ota_begin(s->target, header->target_size, &s->ota_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(ret));
+        return DELTA_ERR_IO;
+    }
+    s->ota_begun = true;
+    return DELTA_OK;
+}
+
+esp_err_t ota_update_delta_begin(void) {
+    if (session.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    session.source = esp_ota_get_running_partition();
+    session.target = esp_ota_get_next_update_partition(NULL);
+    if (!session.source || !session.target) {
+        ESP_LOGE(TAG, "No OTA partition available");
+        return ESP_ERR_NOT_FOUND;
+    }
+    delta_patch_init(&session.patch, read_source, write_target, begin_target, &session);
+    session.ota_begun = false;
+    session.active = true;
+    session.start_us = esp_timer_get_time();
+    session.patch_bytes = 0;
+    ESP_LOGI(TAG, "Delta OTA: %s -> %s", session.source->label, session.target->label);
+    return ESP_OK;
+}
+
+esp_err_t ota_update_delta_write(const uint8_t *data, size_t len) {
+    if (!session.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    delta_status_t status = delta_patch_feed(&session.patch, data, len);
+    session.patch_bytes += len;
+    if (status != DELTA_OK) {
+        ESP_LOGE(TAG, "Delta apply failed: %s", delta_status_str(status));
+        ota_update_delta_abort();
+        switch (status) {
+        case DELTA_ERR_SOURCE: return ESP_ERR_INVALID_VERSION;  // Patch is for another build
+        case DELTA_ERR_RANGE: return ESP_ERR_INVALID_SIZE;
+        default: return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t ota_update_delta_end(void) {
+    if (!session.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    delta_status_t status = session.ota_begun ? delta_patch_finish(&session.patch) : DELTA_ERR_INCOMPLETE;
+    if (status != DELTA_OK) {
+        ESP_LOGE(TAG, "Delta verify failed: %s", delta_status_str(status));
+        ota_update_delta_abort();
+        return status == DELTA_ERR_HASH ? ESP_ERR_INVALID_CRC : ESP_FAIL;
+    }
+    delta_patch_free(&session.patch);
+    session.active = false;
+
+    esp_err_t ret = esp_ota_end(session.ota_handle);
+    if (ret == ESP_OK) {
+        ret = esp_ota_set_boot_partition(session.target);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to finalize OTA image: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    int64_t elapsed_ms = (esp_timer_get_time() - session.start_us) / 1000;
+    ESP_LOGI(TAG, "Delta OTA applied: %lu B patch -> %lu B image in %lld ms, reboot to activate",
+             (unsigned long)session.patch_bytes, (unsigned long)session.patch.written, (long long)elapsed_ms);
+    return ESP_OK;
+}
+
+void ota_update_delta_abort(void) {
+    if (!session.active) {
+        return;
+    }
+    if (session.ota_begun) {
+        esp_ota_abort(session.ota_handle);
+    }
+    delta_patch_free(&session.patch);
+    session.active = false;
+}
+
+esp_err_t ota_update_delta_from_url(const char *url) {
+    // Server certificates are checked against the ESP-IDF CA bundle
+    if (strncmp(url, "https://", 8) != 0) {
+        ESP_LOGE(TAG, "Refusing patch download over plain HTTP: %s", url);
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_http_client_config_t config = {
+        .url = url,
+        .timeout_ms = 10000,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (!client) {
+        return ESP_FAIL;
+    }
+    esp_err_t ret = esp_http_client_open(client, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open %s: %s", url, esp_err_to_name(ret));
+        esp_http_client_cleanup(client);
+        return ret;
+    }
+    esp_http_client_fetch_headers(client);
+
+    ret = ota_update_delta_begin();
+    uint8_t chunk[OTA_HTTP_CHUNK];
+    while (ret == ESP_OK) {
+        int n = esp_http_client_read(client, (char *)chunk, sizeof(chunk));
+        if (n < 0) {
+            ESP_LOGE(TAG, "Patch download failed");
+            ota_update_delta_abort();
+            ret = ESP_FAIL;
+        } else if (n == 0) {
+            ret = ota_update_delta_end();
+            break;
+        } else {
+            ret = ota_update_delta_write(chunk, n);
+        }
+    }
+
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    return ret;
+}
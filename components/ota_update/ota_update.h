@@ -0,0 +1,27 @@
+// components/ota_update/ota_update.h
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+#include <freertos/FreeRTOS.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+esp_err_t ota_update_init();
+// A newly installed image boots pending verification and is rolled back on
+// the next reset unless confirmed. app_main() runs the health check and
+// confirms; an unhealthy image is rolled back straight away.
+bool ota_update_pending_verify(void);
+esp_err_t ota_update_confirm_image(bool healthy);
+
+// Delta OTA: the patch is applied against the running partition and streamed
+// into the inactive OTA partition. The running image is checked against the
+// source hash in the patch before the target is erased, and the boot
+// partition only switches once the rebuilt image matches the target hash.
+esp_err_t ota_update_delta_begin(void);
+esp_err_t ota_update_delta_write(const uint8_t *data, size_t len);
+esp_err_t ota_update_delta_end(void);
+void ota_update_delta_abort(void);
+// Downloads a patch over HTTPS (https:// URLs only) and applies it chunk by chunk
+esp_err_t ota_update_delta_from_url(const char *url);
+
+#endif // OTA_UPDATE_H
@@ -0,0 +1,53 @@
+// components/perf_stats/perf_stats.c
+#include "perf_stats.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "PERF_STATS";
+
+void perf_stats_record(perf_stats_t *stats, uint32_t elapsed_us) {
+    stats->samples[stats->head] = elapsed_us;
+    stats->head = (stats->head + 1) % PERF_STATS_WINDOW;
+    if (stats->count < PERF_STATS_WINDOW) {
+        stats->count++;
+    }
+    if (elapsed_us > stats->max_us) {
+        stats->max_us = elapsed_us;
+    }
+}
+
+static void sort_samples(uint32_t *samples, uint32_t n) {
+    // Insertion sort, the window is small and this runs once per report
+    for (uint32_t i = 1; i < n; i++) {
+        uint32_t v = samples[i];
+        uint32_t j = i;
+        while (j > 0 && samples[j - 1] > v) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = v;
+    }
+}
+
+void perf_stats_report(perf_stats_t *stats) {
+    if (stats->count == 0) {
+        return;
+    }
+
+    uint32_t sorted[PERF_STATS_WINDOW];
+    uint32_t n = stats->count;
+    memcpy(sorted, stats->samples, n * sizeof(uint32_t));
+    sort_samples(sorted, n);
+
+    uint32_t median_us = sorted[n / 2];
+    uint32_t p99_us = sorted[(n * 99) / 100];
+
+    // One JSON object per line so the log can be scraped and compared against host numbers
+    ESP_LOGI(TAG, "{\"kernel\":\"%s\",\"n\":%lu,\"median_us\":%lu,\"p99_us\":%lu,\"max_us\":%lu}",
+             stats->name, (unsigned long)n, (unsigned long)median_us, (unsigned long)p99_us,
+             (unsigned long)stats->max_us);
+
+    stats->count = 0;
+    stats->head = 0;
+    stats->max_us = 0;
+}
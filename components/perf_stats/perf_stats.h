@@ -0,0 +1,28 @@
+// components/perf_stats/perf_stats.h
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <freertos/FreeRTOS.h>
+#include <stdint.h>
+
+// On-target timing of the per-frame kernels. Regressions are gated on the
+// host: test/host/perf_bench.c runs the same kernels on fixed datasets and
+// fails on a >10% slowdown against test/host/bench_baseline.txt.
+
+#define PERF_STATS_WINDOW 64           // Samples kept per kernel for median/p99
+
+typedef struct {
+    const char *name;
+    uint32_t samples[PERF_STATS_WINDOW];
+    uint32_t count;                    // Samples recorded since the last report
+    uint32_t head;
+    uint32_t max_us;
+} perf_stats_t;
+
+#define PERF_STATS_INIT(kernel_name) { .name = (kernel_name) }
+
+void perf_stats_record(perf_stats_t *stats, uint32_t elapsed_us);
+// Logs median/p99/max as a single JSON line and starts a new window
+void perf_stats_report(perf_stats_t *stats);
+
+#endif // PERF_STATS_H
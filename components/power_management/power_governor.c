@@ -0,0 +1,69 @@
+// components/power_management/power_governor.c
+#include "power_governor.h"
+
+// Nominal rates per flight phase. UNKNOWN keeps the pre-governor rates.
+static const task_rates_t phase_rates[FLIGHT_PHASE_COUNT] = {
+    [FLIGHT_PHASE_UNKNOWN] = { .vo_period_ms = 50,  .qr_period_ms = 50,   .ultrasonic_period_ms = 50,
+                               .telemetry_period_ms = 1000, .cpu_max_mhz = 240, .cpu_min_mhz = 240 },
+    [FLIGHT_PHASE_GROUND]  = { .vo_period_ms = 500, .qr_period_ms = 1000, .ultrasonic_period_ms = 500,
+                               .telemetry_period_ms = 2000, .cpu_max_mhz = 160, .cpu_min_mhz = 40 },
+    [FLIGHT_PHASE_HOVER]   = { .vo_period_ms = 100, .qr_period_ms = 200,  .ultrasonic_period_ms = 100,
+                               .telemetry_period_ms = 1000, .cpu_max_mhz = 160, .cpu_min_mhz = 80 },
+    [FLIGHT_PHASE_TRANSIT] = { .vo_period_ms = 50,  .qr_period_ms = 50,   .ultrasonic_period_ms = 50,
+                               .telemetry_period_ms = 1000, .cpu_max_mhz = 240, .cpu_min_mhz = 80 },
+    [FLIGHT_PHASE_LANDING] = { .vo_period_ms = 50,  .qr_period_ms = 50,   .ultrasonic_period_ms = 50,
+                               .telemetry_period_ms = 500,  .cpu_max_mhz = 240, .cpu_min_mhz = 160,
+                               .hold_max_freq = true },
+};
+
+// Latency floors for the safety-critical paths: the longest period each may
+// be stretched to in a phase, whatever the battery or load says. An unknown
+// phase may be any of the airborne ones, so it gets the tightest of them.
+static const task_rates_t phase_floors[FLIGHT_PHASE_COUNT] = {
+    [FLIGHT_PHASE_UNKNOWN] = { .vo_period_ms = 50,   .qr_period_ms = 100,  .ultrasonic_period_ms = 50,   .telemetry_period_ms = 2000 },
+    [FLIGHT_PHASE_GROUND]  = { .vo_period_ms = 1000, .qr_period_ms = 2000, .ultrasonic_period_ms = 1000, .telemetry_period_ms = 5000 },
+    [FLIGHT_PHASE_HOVER]   = { .vo_period_ms = 200,  .qr_period_ms = 1000, .ultrasonic_period_ms = 100,  .telemetry_period_ms = 5000 },
+    [FLIGHT_PHASE_TRANSIT] = { .vo_period_ms = 100,  .qr_period_ms = 200,  .ultrasonic_period_ms = 100,  .telemetry_period_ms = 5000 },
+    [FLIGHT_PHASE_LANDING] = { .vo_period_ms = 50,   .qr_period_ms = 100,  .ultrasonic_period_ms = 50,   .telemetry_period_ms = 2000 },
+};
+
+static uint32_t min_u32(uint32_t a, uint32_t b) {
+    return a < b ? a : b;
+}
+
+static int step_up_mhz(int mhz) {
+    return mhz < 80 ? 80 : (mhz < 160 ? 160 : 240);
+}
+
+void power_governor_evaluate(const governor_input_t *in, task_rates_t *out) {
+    flight_phase_t phase = in->phase < FLIGHT_PHASE_COUNT ? in->phase : FLIGHT_PHASE_UNKNOWN;
+    *out = phase_rates[phase];
+
+    // Stretch the non-critical work as the battery sags
+    uint32_t scale = 1;
+    if (in->battery_voltage > 0.0f && in->battery_voltage < GOVERNOR_BATTERY_CRITICAL_V) {
+        scale = 4;
+    } else if (in->battery_voltage > 0.0f && in->battery_voltage < GOVERNOR_BATTERY_LOW_V) {
+        scale = 2;
+    }
+    out->vo_period_ms *= scale;
+    out->qr_period_ms *= scale;
+    out->ultrasonic_period_ms *= scale;
+    out->telemetry_period_ms *= scale;
+
+    // Clock follows the busiest core; running out of headroom costs deadlines,
+    // so step up before the rates have to give
+    float load = in->core_load[0] > in->core_load[1] ? in->core_load[0] : in->core_load[1];
+    if (load > GOVERNOR_LOAD_HIGH) {
+        out->cpu_max_mhz = step_up_mhz(out->cpu_max_mhz);
+        out->cpu_min_mhz = out->cpu_max_mhz;
+    } else if (load < GOVERNOR_LOAD_LOW && !out->hold_max_freq && out->cpu_min_mhz > 40) {
+        out->cpu_min_mhz = 40;
+    }
+
+    const task_rates_t *floor = &phase_floors[phase];
+    out->vo_period_ms = min_u32(out->vo_period_ms, floor->vo_period_ms);
+    out->qr_period_ms = min_u32(out->qr_period_ms, floor->qr_period_ms);
+    out->ultrasonic_period_ms = min_u32(out->ultrasonic_period_ms, floor->ultrasonic_period_ms);
+    out->telemetry_period_ms = min_u32(out->telemetry_period_ms, floor->telemetry_period_ms);
+}
@@ -0,0 +1,42 @@
+// components/power_management/power_governor.h
+#ifndef POWER_GOVERNOR_H
+#define POWER_GOVERNOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Task rates and CPU clock from flight phase, battery level and load
+
+typedef enum {
+    FLIGHT_PHASE_UNKNOWN,   // Not reported: the pre-governor rates and clock as nominal values
+    FLIGHT_PHASE_GROUND,
+    FLIGHT_PHASE_HOVER,
+    FLIGHT_PHASE_TRANSIT,
+    FLIGHT_PHASE_LANDING,   // Descending onto the QR landing pad
+    FLIGHT_PHASE_COUNT
+} flight_phase_t;
+
+typedef struct {
+    flight_phase_t phase;
+    float battery_voltage;
+    float core_load[2];     // Busy fraction per core, 0..1
+} governor_input_t;
+
+typedef struct {
+    uint32_t vo_period_ms;
+    uint32_t qr_period_ms;
+    uint32_t ultrasonic_period_ms;
+    uint32_t telemetry_period_ms;
+    int cpu_max_mhz;
+    int cpu_min_mhz;
+    bool hold_max_freq;     // Pin the CPU at cpu_max_mhz regardless of idle time
+} task_rates_t;
+
+#define GOVERNOR_BATTERY_LOW_V      10.8f  // 3S pack, 3.6 V per cell
+#define GOVERNOR_BATTERY_CRITICAL_V 10.2f  // 3.4 V per cell
+#define GOVERNOR_LOAD_HIGH          0.80f
+#define GOVERNOR_LOAD_LOW           0.30f
+
+void power_governor_evaluate(const governor_input_t *in, task_rates_t *out);
+
+#endif // POWER_GOVERNOR_H
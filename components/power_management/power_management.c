@@ -0,0 +1,128 @@
+// components/power_management/power_management.c
+#include "power_management.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_adc/adc_oneshot.h"
+#include "resource_monitor.h"
+#include "task_topology.h"
+
+static const char *TAG = "POWER_MGMT";
+
+#define GOVERNOR_PERIOD_MS 500
+#define BATTERY_ADC_CHANNEL ADC_CHANNEL_0   // GPIO1 on the ESP32-S3
+#define BATTERY_DIVIDER_RATIO 5.0f          // 3S pack through a 40k/10k divider
+#define ADC_FULL_SCALE_V 3.1f               // 12 dB attenuation
+#define ADC_MAX_RAW 4095
+
+static adc_oneshot_unit_handle_t adc_handle;
+static esp_pm_lock_handle_t max_freq_lock;
+static bool max_freq_held;
+
+static portMUX_TYPE state_lock = portMUX_INITIALIZER_UNLOCKED;
+// Until the flight phase is reported the governor scales the pre-governor rates
+static flight_phase_t flight_phase = FLIGHT_PHASE_UNKNOWN;
+static task_rates_t current_rates;
+static float battery_voltage;
+
+esp_err_t power_management_init() {
+    governor_input_t in = { .phase = flight_phase };
+    power_governor_evaluate(&in, &current_rates);
+
+    adc_oneshot_unit_init_cfg_t unit_cfg = { .unit_id = ADC_UNIT_1 };
+    ESP_ERROR_CHECK(adc_oneshot_new_unit(&unit_cfg, &adc_handle));
+    adc_oneshot_chan_cfg_t chan_cfg = { .atten = ADC_ATTEN_DB_12, .bitwidth = ADC_BITWIDTH_12 };
+    ESP_ERROR_CHECK(adc_oneshot_config_channel(adc_handle, BATTERY_ADC_CHANNEL, &chan_cfg));
+
+    esp_err_t ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "governor", &max_freq_lock);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "DFS unavailable (%s), running at fixed clock", esp_err_to_name(ret));
+        max_freq_lock = NULL;
+    }
+    return ESP_OK;
+}
+
+void power_management_set_flight_phase(flight_phase_t phase) {
+    taskENTER_CRITICAL(&state_lock);
+    flight_phase = phase;
+    taskEXIT_CRITICAL(&state_lock);
+}
+
+task_rates_t power_management_get_rates(void) {
+    taskENTER_CRITICAL(&state_lock);
+    task_rates_t rates = current_rates;
+    taskEXIT_CRITICAL(&state_lock);
+    return rates;
+}
+
+float power_management_get_battery_voltage(void) {
+    taskENTER_CRITICAL(&state_lock);
+    float voltage = battery_voltage;
+    taskEXIT_CRITICAL(&state_lock);
+    return voltage;
+}
+
+static float read_battery_voltage(void) {
+    int raw;
+    if (adc_oneshot_read(adc_handle, BATTERY_ADC_CHANNEL, &raw) != ESP_OK) {
+        return 0.0f; // Unknown, the governor ignores it
+    }
+    return raw * ADC_FULL_SCALE_V / ADC_MAX_RAW * BATTERY_DIVIDER_RATIO;
+}
+
+static void apply_clock(const task_rates_t *prev, const task_rates_t *next) {
+    if (!max_freq_lock) {
+        return;
+    }
+    if (next->cpu_max_mhz != prev->cpu_max_mhz || next->cpu_min_mhz != prev->cpu_min_mhz) {
+        esp_pm_config_t pm_config = {
+            .max_freq_mhz = next->cpu_max_mhz,
+            .min_freq_mhz = next->cpu_min_mhz,
+            .light_sleep_enable = false,
+        };
+        esp_err_t ret = esp_pm_configure(&pm_config);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "esp_pm_configure(%d-%d MHz) failed: %s", next->cpu_min_mhz, next->cpu_max_mhz, esp_err_to_name(ret));
+        }
+    }
+    if (next->hold_max_freq && !max_freq_held) {
+        esp_pm_lock_acquire(max_freq_lock);
+        max_freq_held = true;
+    } else if (!next->hold_max_freq && max_freq_held) {
+        esp_pm_lock_release(max_freq_lock);
+        max_freq_held = false;
+    }
+}
+
+void power_management_task(void *pvParameters) {
+    task_rates_t applied = { 0 };
+    while (1) {
+        task_monitor_begin();
+        governor_input_t in;
+        resource_monitor_get_core_load(in.core_load);
+        in.battery_voltage = read_battery_voltage();
+        taskENTER_CRITICAL(&state_lock);
+        in.phase = flight_phase;
+        battery_voltage = in.battery_voltage;
+        taskEXIT_CRITICAL(&state_lock);
+
+        task_rates_t next;
+        power_governor_evaluate(&in, &next);
+        apply_clock(&applied, &next);
+
+        taskENTER_CRITICAL(&state_lock);
+        current_rates = next;
+        taskEXIT_CRITICAL(&state_lock);
+
+        if (next.vo_period_ms != applied.vo_period_ms || next.cpu_max_mhz != applied.cpu_max_mhz ||
+            next.cpu_min_mhz != applied.cpu_min_mhz || next.qr_period_ms != applied.qr_period_ms) {
+            ESP_LOGI(TAG, "Phase %d, %.2f V, load %.2f/%.2f: CPU %d-%d MHz, VO %lu ms, QR %lu ms, US %lu ms, TLM %lu ms",
+                     in.phase, in.battery_voltage, in.core_load[0], in.core_load[1], next.cpu_min_mhz, next.cpu_max_mhz,
+                     (unsigned long)next.vo_period_ms, (unsigned long)next.qr_period_ms,
+                     (unsigned long)next.ultrasonic_period_ms, (unsigned long)next.telemetry_period_ms);
+        }
+        applied = next;
+
+        task_monitor_delay(GOVERNOR_PERIOD_MS);
+    }
+    vTaskDelete(NULL);
+}
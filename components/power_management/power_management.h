@@ -0,0 +1,19 @@
+// components/power_management/power_management.h
+#ifndef POWER_MANAGEMENT_H
+#define POWER_MANAGEMENT_H
+
+#include <freertos/FreeRTOS.h>
+#include <stdint.h>
+#include "power_governor.h"
+
+esp_err_t power_management_init();
+void power_management_task(void *pvParameters);
+// Called by the flight controller link on phase changes. Until then the
+// governor scales the pre-governor rates for battery and load
+// (FLIGHT_PHASE_UNKNOWN).
+void power_management_set_flight_phase(flight_phase_t phase);
+// Rates chosen by the governor; periodic tasks read these every cycle
+task_rates_t power_management_get_rates(void);
+float power_management_get_battery_voltage(void);
+
+#endif // POWER_MANAGEMENT_H
@@ -1,84 +1,234 @@
 // components/qr_code/qr_code.c
 #include "qr_code.h"
+#include "qr_tracker.h"
+#include "qr_prefilter.h"
+#include "jpeg_gray.h"
 #include "esp_log.h"
 #include "camera.h"
 #include "esp_qrcode.h"
+#include "perf_stats.h"
+#include "power_management.h"
+#include "task_topology.h"
+#include <esp_attr.h>
 #include <esp_timer.h>
-#include <stdlib.h> // For malloc, free
+#include <string.h>
 
 static const char *TAG = "QR_CODE";
 
+#define QR_PERF_REPORT_FRAMES 64
+#define QR_MAX_RESULTS 4
+
+#define QR_PREFILTER_SHIFT 1      // The prefilter plane is the frame at half resolution
+#define QR_DECODE_MAX_WIDTH 640   // Largest frame decoded for the QR decoder, VGA
+#define QR_DECODE_MAX_HEIGHT 480
+
+// Decoder context and result scratch persist for the lifetime of the task
+static esp_qrcode_handle_t qrcode_handle;
+static esp_qrcode_result_t results[QR_MAX_RESULTS];
+static qr_tracker_t tracker;
+
+// Grayscale planes decoded from the JPEG frame: half resolution for the
+// prefilter, full resolution for the QR decoder, which only reads luminance.
+// Each is written and scanned once per frame, so they can live in PSRAM.
+EXT_RAM_BSS_ATTR static uint8_t prefilter_plane[(QR_DECODE_MAX_WIDTH >> QR_PREFILTER_SHIFT) *
+                                                (QR_DECODE_MAX_HEIGHT >> QR_PREFILTER_SHIFT)];
+EXT_RAM_BSS_ATTR static uint8_t decode_plane[QR_DECODE_MAX_WIDTH * QR_DECODE_MAX_HEIGHT];
+static uint8_t jpeg_pool[JPEG_GRAY_WORKSPACE];
+
+// Payload pool, ownership of a slot moves with the result through the queue
+static qr_result_pool_t payload_pool;
+
+static perf_stats_t decode_stats = PERF_STATS_INIT("qr_decode");
+static perf_stats_t prefilter_stats = PERF_STATS_INIT("qr_prefilter");
+static uint32_t frames_with_detection;
+static uint32_t frames_skipped;
+static uint32_t results_dropped;
+
+// The frame as the grayscale plane the QR decoder reads, or NULL if it cannot
+// be converted. Grayscale frames are used in place.
+static const uint8_t *decoder_plane(const camera_fb_t *fb) {
+    if (fb->format == PIXFORMAT_GRAYSCALE) {
+        return fb->buf;
+    }
+    if (fb->format != PIXFORMAT_JPEG || fb->width > QR_DECODE_MAX_WIDTH || fb->height > QR_DECODE_MAX_HEIGHT) {
+        ESP_LOGE(TAG, "Unsupported frame: format %d, %ux%u", fb->format, (unsigned)fb->width, (unsigned)fb->height);
+        return NULL;
+    }
+    if (jpeg_gray_decode(fb->buf, fb->len, jpeg_pool, decode_plane, (int)fb->width, (int)fb->height) != ESP_OK) {
+        return NULL;
+    }
+    return decode_plane;
+}
+
+// Decodes the frame to the half-resolution plane and scans it for finder
+// patterns. Codes under about 2.5 frame pixels per module blur out at half
+// resolution, so when that finds nothing the full-resolution plane the decoder
+// needs anyway is scanned too; *plane is then set so it is not decoded twice.
+// Returns false only when the frame was scanned and holds no candidate; roi is
+// then left as is. A frame that cannot be scanned is reported as a candidate
+// so it still goes to the decoder.
+static bool prefilter_frame(const camera_fb_t *fb, qr_roi_t *roi, const uint8_t **plane) {
+    int frame_width = (int)fb->width, frame_height = (int)fb->height;
+    int plane_width = frame_width >> QR_PREFILTER_SHIFT;
+    int plane_height = frame_height >> QR_PREFILTER_SHIFT;
+    if (fb->format != PIXFORMAT_JPEG || frame_width > QR_DECODE_MAX_WIDTH || frame_height > QR_DECODE_MAX_HEIGHT) {
+        return true;
+    }
+
+    // Timed together, the gray decode is part of the prefilter's cost
+    int64_t start_us = esp_timer_get_time();
+    if (jpeg_gray_decode(fb->buf, fb->len, jpeg_pool, prefilter_plane, plane_width, plane_height) != ESP_OK) {
+        return true;
+    }
+    qr_roi_t found;
+    bool candidates = qr_prefilter_find(prefilter_plane, plane_width, plane_height, &found) > 0;
+    if (!candidates) {
+        *plane = decoder_plane(fb);
+        candidates = !*plane || qr_prefilter_find(*plane, frame_width, frame_height, &found) >= QR_PREFILTER_RETRY_FINDERS;
+        if (*plane && candidates) {
+            *roi = found;
+        }
+    } else {
+        roi->x0 = found.x0 << QR_PREFILTER_SHIFT;
+        roi->y0 = found.y0 << QR_PREFILTER_SHIFT;
+        roi->width = found.width << QR_PREFILTER_SHIFT;
+        roi->height = found.height << QR_PREFILTER_SHIFT;
+        // An odd frame size leaves a last row or column the plane does not cover
+        if (roi->x0 + roi->width > frame_width) {
+            roi->width = frame_width - roi->x0;
+        }
+        if (roi->y0 + roi->height > frame_height) {
+            roi->height = frame_height - roi->y0;
+        }
+    }
+    perf_stats_record(&prefilter_stats, (uint32_t)(esp_timer_get_time() - start_us));
+    return candidates;
+}
+
 esp_err_t qr_code_init() {
+    if (qrcode_handle) {
+        return ESP_OK;
+    }
+    qrcode_handle = esp_qrcode_create();
+    if (!qrcode_handle) {
+        ESP_LOGE(TAG, "Failed to create QR code handle");
+        return ESP_ERR_NO_MEM;
+    }
+    qr_tracker_reset(&tracker);
+    qr_result_pool_init(&payload_pool);
     return ESP_OK;
 }
 
+const uint8_t *qr_code_result_data(const qr_code_result_t *result) {
+    return qr_result_pool_data(&payload_pool, result->slot);
+}
+
+void qr_code_result_release(const qr_code_result_t *result) {
+    if (!qr_result_pool_release(&payload_pool, result->slot)) {
+        ESP_LOGE(TAG, "QR result slot %d is invalid or was already released", result->slot);
+    }
+}
+
 static void decode_qr_code(camera_fb_t *fb, QueueHandle_t qr_code_queue) {
     if (!fb) {
         ESP_LOGE(TAG, "Received null frame buffer");
         return;
     }
 
-    esp_qrcode_handle_t qrcode_handle = esp_qrcode_create();
-    if (!qrcode_handle) {
-        ESP_LOGE(TAG, "Failed to create QR code handle");
+    // Search around the last detection first; fall back to a full-frame scan
+    // when not tracking and periodically to pick up codes elsewhere in view.
+    // Without a track, full-frame scans go through the finder prefilter, which
+    // crops the decode to the candidate region or skips the frame outright. An
+    // occasional unfiltered scan still runs in case the prefilter misses a code.
+    qr_roi_t roi;
+    const uint8_t *plane = NULL;
+    qr_scan_t scan = qr_tracker_begin_frame(&tracker, fb->width, fb->height, &roi);
+    if (scan == QR_SCAN_FILTERED && !prefilter_frame(fb, &roi, &plane)) {
+        frames_skipped++;
         return;
     }
+    bool full_scan = scan != QR_SCAN_ROI;
 
     esp_qrcode_config_t config = {
         .max_decode_steps = 8,
-        .try_harder = true,
-        .roi_x0 = 0, // Example: Scan the entire image
-        .roi_y0 = 0,
-        .roi_width = fb->width,
-        .roi_height = fb->height,
+        .try_harder = full_scan, // The ROI is small enough for a fast pass
+        .roi_x0 = roi.x0,
+        .roi_y0 = roi.y0,
+        .roi_width = roi.width,
+        .roi_height = roi.height,
         .enable_grayscale = true
     };
     esp_qrcode_configure(qrcode_handle, &config);
 
-    esp_timer_handle_t timer;
-    esp_timer_create_args_t timer_args = {
-        .callback = NULL,
-        .name = "qr_decode_timer",
-        .dispatch_method = ESP_TIMER_TASK,
-    };
-    esp_timer_create(&timer_args, &timer);
-    esp_timer_start_once(timer, 100000);
-
-    esp_qrcode_decode_image(qrcode_handle, fb->buf, fb->width, fb->height);
-
-    esp_timer_stop(timer);
-    uint64_t decode_time_us = esp_timer_get_time();
+    // Timed together, the gray decode is part of the decoder's cost
+    int64_t start_us = esp_timer_get_time();
+    if (!plane) {
+        plane = decoder_plane(fb);
+    }
+    if (!plane) {
+        return;
+    }
+    esp_qrcode_decode_image(qrcode_handle, plane, fb->width, fb->height);
+    int num_found = esp_qrcode_get_results(qrcode_handle, results, QR_MAX_RESULTS);
+    int64_t decode_time_us = esp_timer_get_time() - start_us;
+    perf_stats_record(&decode_stats, (uint32_t)decode_time_us);
 
-    esp_qrcode_result_t results[4];
-    int num_found = esp_qrcode_get_results(qrcode_handle, results, 4);
+    ESP_LOGD(TAG, "Found %d QR codes in %lld us (%s scan)", num_found, (long long)decode_time_us, full_scan ? "full" : "roi");
 
-    ESP_LOGI(TAG, "Found %d QR codes in %llu us", num_found, decode_time_us);
+    if (num_found > 0) {
+        frames_with_detection++;
+        qr_roi_t box = { results[0].roi_x0, results[0].roi_y0, results[0].roi_width, results[0].roi_height };
+        qr_tracker_found(&tracker, &box);
+    } else if (qr_tracker_missed(&tracker)) {
+        ESP_LOGI(TAG, "QR code track lost");
+    }
 
     for (int i = 0; i < num_found; i++) {
-        qr_code_result_t result;
-        result.data_len = results[i].payload_len;
-        result.data = malloc(result.data_len + 1); // +1 for null terminator
-        if (result.data) {
-            memcpy(result.data, results[i].payload, result.data_len);
-            result.data[result.data_len] = '\0'; // Null-terminate the string
-            result.confidence = 90; // Example confidence
-            ESP_LOGI(TAG, "Decoded QR Code: %s (Confidence: %d%%)", result.data, result.confidence);
-            if (xQueueSend(qr_code_queue, &result, 0) != pdTRUE) {
-                ESP_LOGW(TAG, "Failed to send QR code result to queue");
-            }
-            free(result.data);
-        } else {
-            ESP_LOGE(TAG, "Failed to allocate memory for QR code data");
+        if (results[i].payload_len > QR_MAX_PAYLOAD_LEN) {
+            ESP_LOGW(TAG, "QR payload of %u bytes exceeds %d, dropped", (unsigned)results[i].payload_len, QR_MAX_PAYLOAD_LEN);
+            continue;
+        }
+        int slot = qr_result_pool_acquire(&payload_pool);
+        if (slot < 0) {
+            results_dropped++;
+            ESP_LOGW(TAG, "QR result pool exhausted, result dropped");
+            continue;
+        }
+        qr_code_result_t result = {
+            .slot = (uint8_t)slot,
+            .data_len = results[i].payload_len,
+            .confidence = 90, // Example confidence
+        };
+        uint8_t *payload = qr_result_pool_data(&payload_pool, slot);
+        memcpy(payload, results[i].payload, result.data_len);
+        payload[result.data_len] = '\0'; // Null-terminate the string
+        ESP_LOGI(TAG, "Decoded QR Code: %s (Confidence: %d%%)", payload, result.confidence);
+        if (xQueueSend(qr_code_queue, &result, 0) != pdTRUE) {
+            ESP_LOGW(TAG, "Failed to send QR code result to queue");
+            qr_code_result_release(&result);
         }
     }
-    esp_qrcode_destroy(qrcode_handle);
 }
 
 void qr_code_task(void *pvParameters) {
     QueueHandle_t qr_code_queue = (QueueHandle_t)pvParameters;
     camera_fb_t *fb = NULL;
+    int frames_since_report = 0;
+
+    if (qr_code_init() != ESP_OK) {
+        vTaskDelete(NULL);
+        return;
+    }
 
     while (1) {
+        task_monitor_begin();
+        // Backpressure: hold off decoding until the consumer returns a slot
+        if (!qr_result_pool_has_free(&payload_pool)) {
+            ESP_LOGW(TAG, "QR result pool full, waiting for consumer");
+            vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
+
         fb = esp_camera_fb_get();
         if (!fb) {
             ESP_LOGE(TAG, "Camera capture failed");
@@ -89,8 +239,19 @@ void qr_code_task(void *pvParameters) {
         decode_qr_code(fb, qr_code_queue);
 
         esp_camera_fb_return(fb);
-        vTaskDelay(pdMS_TO_TICKS(50));
+
+        if (++frames_since_report >= QR_PERF_REPORT_FRAMES) {
+            perf_stats_report(&decode_stats);
+            perf_stats_report(&prefilter_stats);
+            ESP_LOGI(TAG, "Detection rate: %lu/%d frames, %lu skipped by prefilter, %lu results dropped",
+                     (unsigned long)frames_with_detection, frames_since_report, (unsigned long)frames_skipped,
+                     (unsigned long)results_dropped);
+            frames_with_detection = 0;
+            frames_skipped = 0;
+            results_dropped = 0;
+            frames_since_report = 0;
+        }
+        task_monitor_delay(power_management_get_rates().qr_period_ms);
     }
     vTaskDelete(NULL);
 }
-
@@ -4,9 +4,12 @@
 
 #include <freertos/FreeRTOS.h>
 #include <stdint.h>
+#include "qr_result_pool.h"
 
+// The payload lives in a preallocated pool slot owned by whoever holds the
+// result. The consumer must call qr_code_result_release() when done with it.
 typedef struct {
-    uint8_t* data;
+    uint8_t slot;
     size_t data_len;
     int confidence;
     // Add Region of Interest data if needed
@@ -14,6 +17,8 @@ typedef struct {
 
 esp_err_t qr_code_init();
 void qr_code_task(void *pvParameters);
+const uint8_t *qr_code_result_data(const qr_code_result_t *result); // Null-terminated, NULL for a bad slot
+void qr_code_result_release(const qr_code_result_t *result);
 
 #endif // QR_CODE_H
 
@@ -0,0 +1,183 @@
+// components/qr_code/qr_prefilter.c
+#include "qr_prefilter.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A finder candidate collects the confirmed crossings that line up across
+// consecutive rows, wherever they fall in the frame
+typedef struct {
+    int x_sum;                  // Sum of crossing centers, for the mean column
+    int y_first, y_last;
+    int total_sum;              // Sum of crossing widths, 7 modules each
+    int hits;
+} finder_candidate_t;
+
+static uint8_t prefilter_row[QR_PREFILTER_MAX_WIDTH];
+static finder_candidate_t candidates[QR_PREFILTER_MAX_CANDIDATES];
+static int candidate_count;
+
+static int clamp_int(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Five runs (dark, light, dark, light, dark) in 1:1:3:1:1 proportion, with
+// half a module of tolerance on each run
+static inline bool is_finder_ratio(const uint16_t *runs) {
+    int total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+    if (total < 7) {
+        return false;
+    }
+    return abs(7 * runs[0] - total) * 2 < total &&
+           abs(7 * runs[1] - total) * 2 < total &&
+           abs(7 * runs[2] - 3 * total) * 2 < 3 * total &&
+           abs(7 * runs[3] - total) * 2 < total &&
+           abs(7 * runs[4] - total) * 2 < total;
+}
+
+// Confirm a horizontal hit by measuring the same five runs vertically through
+// its center column, which rejects most texture and noise
+static bool cross_check_vertical(const uint8_t *gray, int width, int height, int cx, int cy, uint8_t threshold, int max_total) {
+    uint16_t runs[5] = {0};
+    int y = cy;
+    // Center dark run, then light and dark runs upward
+    while (y >= 0 && gray[y * width + cx] < threshold && runs[2] <= max_total) { runs[2]++; y--; }
+    while (y >= 0 && gray[y * width + cx] >= threshold && runs[1] <= max_total) { runs[1]++; y--; }
+    while (y >= 0 && gray[y * width + cx] < threshold && runs[0] <= max_total) { runs[0]++; y--; }
+    y = cy + 1;
+    while (y < height && gray[y * width + cx] < threshold && runs[2] <= max_total) { runs[2]++; y++; }
+    while (y < height && gray[y * width + cx] >= threshold && runs[3] <= max_total) { runs[3]++; y++; }
+    while (y < height && gray[y * width + cx] < threshold && runs[4] <= max_total) { runs[4]++; y++; }
+    return is_finder_ratio(runs);
+}
+
+static void add_hit(int x, int y, int total) {
+    for (int i = candidate_count - 1; i >= 0; i--) {
+        finder_candidate_t *c = &candidates[i];
+        // Same finder when on the next row or two and within a module of its column
+        if (y - c->y_last <= 2 && abs(x * c->hits - c->x_sum) * 7 <= total * c->hits) {
+            c->x_sum += x;
+            c->y_last = y;
+            c->total_sum += total;
+            c->hits++;
+            return;
+        }
+    }
+    if (candidate_count < QR_PREFILTER_MAX_CANDIDATES) {
+        candidates[candidate_count++] = (finder_candidate_t){ x, y, y, total, 1 };
+    }
+}
+
+// A real finder is crossed by every row through its 3-module center, texture
+// that happens to match the ratio rarely is
+static bool is_finder(const finder_candidate_t *c) {
+    return c->hits >= QR_PREFILTER_MIN_HITS && c->hits * 14 >= 3 * c->total_sum / c->hits;
+}
+
+int qr_prefilter_find(const uint8_t *gray, int width, int height, qr_roi_t *roi) {
+    candidate_count = 0;
+
+    for (int y = 0; y < height; y++) {
+        const uint8_t *src = gray + y * width;
+
+        // Binarize against the row mean; both loops are branch-free and vectorize
+        uint32_t sum = 0;
+        for (int i = 0; i < width; i++) {
+            sum += src[i];
+        }
+        uint8_t threshold = (uint8_t)(sum / width);
+        for (int i = 0; i < width; i++) {
+            prefilter_row[i] = src[i] < threshold;
+        }
+
+        // Run-length walk keeping the last five runs
+        uint16_t runs[5] = {0};
+        int run_count = 0;
+        uint8_t current = prefilter_row[0];
+        uint16_t length = 0;
+        for (int i = 0; i <= width; i++) {
+            if (i < width && prefilter_row[i] == current) {
+                length++;
+                continue;
+            }
+            memmove(runs, runs + 1, 4 * sizeof(uint16_t));
+            runs[4] = length;
+            run_count++;
+            // A finder ends on a dark run
+            if (current && run_count >= 5 && is_finder_ratio(runs)) {
+                int center = i - length - runs[3] - runs[2] / 2;
+                int total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+                if (cross_check_vertical(gray, width, height, center, y, threshold, total * 2)) {
+                    add_hit(center, y, total);
+                }
+            }
+            if (i < width) {
+                current = prefilter_row[i];
+                length = 1;
+            }
+        }
+    }
+
+    int finders = 0, module = 0;
+    int fx[3], fy[3];
+    int min_x = width, min_y = height, max_x = -1, max_y = -1;
+    for (int i = 0; i < candidate_count; i++) {
+        const finder_candidate_t *c = &candidates[i];
+        if (!is_finder(c)) {
+            continue;
+        }
+        int x = c->x_sum / c->hits;
+        int y = (c->y_first + c->y_last) / 2;
+        if (finders < 3) {
+            fx[finders] = x;
+            fy[finders] = y;
+        }
+        min_x = x < min_x ? x : min_x;
+        max_x = x > max_x ? x : max_x;
+        min_y = y < min_y ? y : min_y;
+        max_y = y > max_y ? y : max_y;
+        int finder_module = (c->total_sum / c->hits + 6) / 7;
+        module = finder_module > module ? finder_module : module;
+        finders++;
+    }
+    if (!finders) {
+        return 0;
+    }
+
+    // Finder centers sit 3.5 modules in from the code's corners, 5 once the
+    // code is rotated. With one finder the code may extend to any side. With
+    // three, the fourth corner completes the parallelogram on the corner
+    // finder, the one opposite the longest side. With two, or with texture
+    // among the finders, the missing side may lie perpendicular to the span
+    // on either side.
+    int pad = finders == 1 ? QR_PREFILTER_MAX_MODULES * module : QR_PREFILTER_PAD_MODULES * module;
+    int pad_x = pad, pad_y = pad;
+    if (finders == 3) {
+        int corner = 0, longest = -1;
+        for (int i = 0; i < 3; i++) {
+            int a = (i + 1) % 3, b = (i + 2) % 3;
+            int side = (fx[a] - fx[b]) * (fx[a] - fx[b]) + (fy[a] - fy[b]) * (fy[a] - fy[b]);
+            if (side > longest) {
+                longest = side;
+                corner = i;
+            }
+        }
+        int x = fx[(corner + 1) % 3] + fx[(corner + 2) % 3] - fx[corner];
+        int y = fy[(corner + 1) % 3] + fy[(corner + 2) % 3] - fy[corner];
+        min_x = x < min_x ? x : min_x;
+        max_x = x > max_x ? x : max_x;
+        min_y = y < min_y ? y : min_y;
+        max_y = y > max_y ? y : max_y;
+    } else if (finders > 1) {
+        pad_x += max_y - min_y;
+        pad_y += max_x - min_x;
+    }
+    int x0 = clamp_int(min_x - pad_x, 0, width - 1);
+    int y0 = clamp_int(min_y - pad_y, 0, height - 1);
+    int x1 = clamp_int(max_x + pad_x + 1, x0 + 1, width);
+    int y1 = clamp_int(max_y + pad_y + 1, y0 + 1, height);
+    roi->x0 = x0;
+    roi->y0 = y0;
+    roi->width = x1 - x0;
+    roi->height = y1 - y0;
+    return finders;
+}
@@ -0,0 +1,23 @@
+// components/qr_code/qr_prefilter.h
+#ifndef QR_PREFILTER_H
+#define QR_PREFILTER_H
+
+#include "qr_tracker.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QR_PREFILTER_MAX_WIDTH 640  // Plane size limit, a VGA frame
+#define QR_PREFILTER_MAX_HEIGHT 480
+#define QR_PREFILTER_MAX_CANDIDATES 32
+#define QR_PREFILTER_MIN_HITS 2     // Confirmed rows crossing a finder before it counts
+#define QR_PREFILTER_PAD_MODULES 6  // Finder center to code corner plus a quiet zone margin
+#define QR_PREFILTER_MAX_MODULES 25 // Largest code expected, version 2
+#define QR_PREFILTER_RETRY_FINDERS 2 // Finders a full-resolution retry needs; lone ones there are mostly texture
+
+// Scans a grayscale plane for the 1:1:3:1:1 finder-pattern run-length
+// signature and returns the number of finder patterns seen, with the region
+// (plane pixels) the code can occupy given them. 0 means the frame is not
+// worth decoding.
+int qr_prefilter_find(const uint8_t *gray, int width, int height, qr_roi_t *roi);
+
+#endif // QR_PREFILTER_H
@@ -0,0 +1,40 @@
+// components/qr_code/qr_result_pool.c
+#include "qr_result_pool.h"
+#include <stddef.h>
+
+#define QR_RESULT_POOL_ALL ((uint_fast32_t)(((uint64_t)1 << QR_RESULT_POOL_SIZE) - 1))
+
+void qr_result_pool_init(qr_result_pool_t *pool) {
+    atomic_init(&pool->free_slots, QR_RESULT_POOL_ALL);
+}
+
+int qr_result_pool_acquire(qr_result_pool_t *pool) {
+    uint_fast32_t free_slots = atomic_load(&pool->free_slots);
+    while (free_slots) {
+        int slot = __builtin_ctz((unsigned)free_slots);
+        // On failure free_slots is reloaded and the lowest free slot picked again
+        if (atomic_compare_exchange_weak(&pool->free_slots, &free_slots, free_slots & ~((uint_fast32_t)1 << slot))) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+bool qr_result_pool_release(qr_result_pool_t *pool, int slot) {
+    if (slot < 0 || slot >= QR_RESULT_POOL_SIZE) {
+        return false;
+    }
+    uint_fast32_t bit = (uint_fast32_t)1 << slot;
+    return (atomic_fetch_or(&pool->free_slots, bit) & bit) == 0;
+}
+
+uint8_t *qr_result_pool_data(qr_result_pool_t *pool, int slot) {
+    if (slot < 0 || slot >= QR_RESULT_POOL_SIZE) {
+        return NULL;
+    }
+    return pool->data[slot];
+}
+
+bool qr_result_pool_has_free(qr_result_pool_t *pool) {
+    return atomic_load(&pool->free_slots) != 0;
+}
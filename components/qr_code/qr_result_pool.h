@@ -0,0 +1,29 @@
+// components/qr_code/qr_result_pool.h
+#ifndef QR_RESULT_POOL_H
+#define QR_RESULT_POOL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QR_MAX_PAYLOAD_LEN 128   // Largest payload carried, longer codes are rejected
+#define QR_RESULT_POOL_SIZE 8     // Queue depth plus slots held by the consumer
+
+// One bit per slot in the free mask
+_Static_assert(QR_RESULT_POOL_SIZE <= 32, "QR result pool is tracked in a 32-bit mask");
+
+// Fixed pool of payload buffers. The producer acquires a slot, fills it and
+// passes the slot index on; whoever holds the index releases it. The free mask
+// is updated with atomic compare-and-swap so either side may run on any core.
+typedef struct {
+    atomic_uint_fast32_t free_slots;
+    uint8_t data[QR_RESULT_POOL_SIZE][QR_MAX_PAYLOAD_LEN + 1];
+} qr_result_pool_t;
+
+void qr_result_pool_init(qr_result_pool_t *pool);
+int qr_result_pool_acquire(qr_result_pool_t *pool);                 // Slot index, -1 when exhausted
+bool qr_result_pool_release(qr_result_pool_t *pool, int slot);      // False on an invalid or double release
+uint8_t *qr_result_pool_data(qr_result_pool_t *pool, int slot);     // NULL for an invalid slot
+bool qr_result_pool_has_free(qr_result_pool_t *pool);
+
+#endif // QR_RESULT_POOL_H
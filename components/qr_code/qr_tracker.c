@@ -0,0 +1,75 @@
+// components/qr_code/qr_tracker.c
+#include "qr_tracker.h"
+#include <string.h>
+
+static int clamp_int(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+void qr_tracker_reset(qr_tracker_t *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+// Last bounding box shifted by the motion since that detection and grown by
+// the margin, clipped to the frame
+static qr_roi_t predict_roi(const qr_tracker_t *t, int frame_width, int frame_height) {
+    int32_t elapsed = (int32_t)(t->frame - t->last_frame);
+    int shift_x = (t->vx_q8 * elapsed) / 256;
+    int shift_y = (t->vy_q8 * elapsed) / 256;
+    int margin_x = t->last.width * QR_ROI_MARGIN_PCT / 100;
+    int margin_y = t->last.height * QR_ROI_MARGIN_PCT / 100;
+    int x0 = clamp_int(t->last.x0 + shift_x - margin_x, 0, frame_width - 1);
+    int y0 = clamp_int(t->last.y0 + shift_y - margin_y, 0, frame_height - 1);
+    int x1 = clamp_int(t->last.x0 + shift_x + t->last.width + margin_x, x0 + 1, frame_width);
+    int y1 = clamp_int(t->last.y0 + shift_y + t->last.height + margin_y, y0 + 1, frame_height);
+    qr_roi_t roi = { x0, y0, x1 - x0, y1 - y0 };
+    return roi;
+}
+
+qr_scan_t qr_tracker_begin_frame(qr_tracker_t *t, int frame_width, int frame_height, qr_roi_t *roi) {
+    t->frame++;
+    bool forced = ++t->frames_since_forced_scan >= QR_FORCED_FULL_SCAN_INTERVAL;
+    if (forced) {
+        t->frames_since_forced_scan = 0;
+    }
+    if (t->active && t->frames_since_full_scan < QR_FULL_SCAN_INTERVAL && !forced) {
+        *roi = predict_roi(t, frame_width, frame_height);
+        t->frames_since_full_scan++;
+        return QR_SCAN_ROI;
+    }
+    t->frames_since_full_scan = 0;
+    roi->x0 = 0;
+    roi->y0 = 0;
+    roi->width = frame_width;
+    roi->height = frame_height;
+    return t->active || forced ? QR_SCAN_FULL : QR_SCAN_FILTERED;
+}
+
+void qr_tracker_found(qr_tracker_t *t, const qr_roi_t *box) {
+    if (t->active) {
+        // Detections can be several frames apart after misses or skipped frames
+        int32_t gap = (int32_t)(t->frame - t->last_frame);
+        if (gap < 1) {
+            gap = 1;
+        }
+        int dx = (box->x0 + box->width / 2) - (t->last.x0 + t->last.width / 2);
+        int dy = (box->y0 + box->height / 2) - (t->last.y0 + t->last.height / 2);
+        t->vx_q8 = dx * 256 / gap;
+        t->vy_q8 = dy * 256 / gap;
+    } else {
+        t->vx_q8 = 0;
+        t->vy_q8 = 0;
+    }
+    t->last = *box;
+    t->last_frame = t->frame;
+    t->active = true;
+    t->missed_frames = 0;
+}
+
+bool qr_tracker_missed(qr_tracker_t *t) {
+    if (t->active && ++t->missed_frames >= QR_TRACK_LOST_FRAMES) {
+        t->active = false;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,45 @@
+// components/qr_code/qr_tracker.h
+#ifndef QR_TRACKER_H
+#define QR_TRACKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QR_FULL_SCAN_INTERVAL 10  // Frames between forced full-frame scans while tracking
+#define QR_TRACK_LOST_FRAMES 3    // Consecutive misses before tracking is dropped
+#define QR_ROI_MARGIN_PCT 50      // ROI growth around the last detection, per side
+#define QR_FORCED_FULL_SCAN_INTERVAL 50 // Unfiltered full-frame decodes bound prefilter false negatives
+
+typedef enum {
+    QR_SCAN_ROI,                  // Predicted region around the last detection
+    QR_SCAN_FILTERED,             // Full frame, skipped if the finder prefilter sees nothing
+    QR_SCAN_FULL,                 // Full frame, straight to the decoder
+} qr_scan_t;
+
+typedef struct {
+    int x0, y0;
+    int width, height;
+} qr_roi_t;
+
+// Predicts where the code will be from its last two detections.
+typedef struct {
+    bool active;
+    qr_roi_t last;                // Bounding box of the last detection
+    uint32_t last_frame;          // Frame index of the last detection
+    int32_t vx_q8, vy_q8;         // Center motion per frame, 1/256 pixel
+    int missed_frames;
+    int frames_since_full_scan;
+    int frames_since_forced_scan;
+    uint32_t frame;               // Index of the frame being searched
+} qr_tracker_t;
+
+void qr_tracker_reset(qr_tracker_t *t);
+// Starts the next frame and picks how to search it; roi is the whole frame or
+// the predicted region. Only frames without a track go through the prefilter,
+// so a code too small for it is not dropped on a periodic full scan.
+qr_scan_t qr_tracker_begin_frame(qr_tracker_t *t, int frame_width, int frame_height, qr_roi_t *roi);
+void qr_tracker_found(qr_tracker_t *t, const qr_roi_t *box);
+// Returns true when this miss drops the track
+bool qr_tracker_missed(qr_tracker_t *t);
+
+#endif // QR_TRACKER_H
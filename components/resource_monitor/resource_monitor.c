@@ -0,0 +1,272 @@
+// components/resource_monitor/resource_monitor.c
+#include "resource_monitor.h"
+#include "esp_log.h"
+#include "task_topology.h"
+#include <freertos/task.h>
+#include <stdio.h>
+#include <string.h>
+#if CONFIG_RESMON_PROFILER
+#include "driver/gptimer.h"
+#include "esp_ipc.h"
+#include "esp_cpu.h"
+#include "esp_attr.h"
+#include "esp_debug_helpers.h"
+#include <xtensa_context.h>
+#endif
+
+static const char *TAG = "RESOURCE_MONITOR";
+
+#define RESMON_PERIOD_MS 1000
+#define RESMON_LOG_PERIODS 10   // Per-task table is logged every 10 periods
+
+// Run-time stats snapshot from the previous period, matched by task number
+typedef struct {
+    UBaseType_t task_number;
+    uint32_t run_time;
+} run_time_entry_t;
+
+static TaskStatus_t task_status[RESMON_MAX_TASKS];
+static UBaseType_t task_status_count;
+static task_usage_t usage_scratch[RESMON_MAX_TASKS]; // Too large for RESMON_TASK_STACK
+static run_time_entry_t prev_run_time[RESMON_MAX_TASKS];
+static run_time_entry_t next_run_time[RESMON_MAX_TASKS];
+static int prev_count;
+static uint32_t prev_total_run_time;
+
+// Results, read by telemetry and the power governor
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static task_usage_t task_usage[RESMON_MAX_TASKS];
+static int task_usage_count;
+static float core_load[portNUM_PROCESSORS];
+static uint32_t min_stack_free;    // 0 until the first sample
+
+#if CONFIG_RESMON_PROFILER
+#define PROFILER_HZ 250
+#define PROFILER_SAMPLES 256    // Per core, dumped when full
+#define PROFILER_DEPTH 6        // Frames kept per sample, leaf first
+
+// The task is recorded by number rather than handle: it may have been
+// deleted by the time the samples are dumped
+typedef struct {
+    uint32_t pc[PROFILER_DEPTH];
+    uint8_t depth;
+    UBaseType_t task_number;
+} profiler_sample_t;
+
+static profiler_sample_t profiler_samples[portNUM_PROCESSORS][PROFILER_SAMPLES];
+static volatile uint32_t profiler_count[portNUM_PROCESSORS];
+
+// Runs on the core it samples. On entry to the first-level interrupt the port
+// spills the register windows, saves the interrupted task's exception frame
+// on its stack and stores that stack pointer in the TCB's first field,
+// pxTopOfStack. The frame gives the PC, return address and stack pointer to
+// start the backtrace from.
+static bool IRAM_ATTR profiler_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    int core = esp_cpu_get_core_id();
+    uint32_t n = profiler_count[core];
+    if (n < PROFILER_SAMPLES) {
+        TaskHandle_t task = xTaskGetCurrentTaskHandleForCore(core);
+        const XtExcFrame *exc = *(const XtExcFrame **)task;
+        profiler_sample_t *sample = &profiler_samples[core][n];
+        esp_backtrace_frame_t frame = {
+            .pc = exc->pc,
+            .sp = exc->a1,
+            .next_pc = exc->a0,
+        };
+        sample->pc[0] = frame.pc;
+        sample->depth = 1;
+        while (sample->depth < PROFILER_DEPTH && frame.next_pc && esp_backtrace_get_next_frame(&frame) &&
+               esp_ptr_executable((void *)esp_cpu_process_stack_pc(frame.pc))) {
+            sample->pc[sample->depth++] = esp_cpu_process_stack_pc(frame.pc);
+        }
+        sample->task_number = uxTaskGetTaskNumber(task);
+        profiler_count[core] = n + 1;
+    }
+    return false;
+}
+
+// Called through esp_ipc so each core's timer interrupt is allocated on that core
+static void profiler_start_on_core(void *arg) {
+    gptimer_handle_t timer;
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,
+        .intr_priority = 1, // Level 1, so the sample always sees the first-level frame
+    };
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = 1000000 / PROFILER_HZ,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    gptimer_event_callbacks_t callbacks = { .on_alarm = profiler_isr };
+    if (gptimer_new_timer(&timer_config, &timer) != ESP_OK ||
+        gptimer_register_event_callbacks(timer, &callbacks, NULL) != ESP_OK ||
+        gptimer_set_alarm_action(timer, &alarm_config) != ESP_OK ||
+        gptimer_enable(timer) != ESP_OK ||
+        gptimer_start(timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start profiler timer on core %d", esp_cpu_get_core_id());
+    }
+}
+
+// Names come from the latest run-time stats snapshot; a task created and
+// deleted between two snapshots is printed as task#<number>
+static void profiler_task_name(UBaseType_t task_number, char *name, size_t len) {
+    for (UBaseType_t i = 0; i < task_status_count; i++) {
+        if (task_status[i].xTaskNumber == task_number) {
+            strlcpy(name, task_status[i].pcTaskName, len);
+            return;
+        }
+    }
+    snprintf(name, len, "task#%u", (unsigned)task_number);
+}
+
+// Lines are "PROF core;task;leaf_pc,caller_pc,...", symbolized and folded on
+// the host by tools/fold_profile.py
+static void profiler_dump(void) {
+    char name[configMAX_TASK_NAME_LEN + 8];
+    char pcs[PROFILER_DEPTH * 11 + 1];
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t n = profiler_count[core];
+        for (uint32_t i = 0; i < n; i++) {
+            const profiler_sample_t *sample = &profiler_samples[core][i];
+            int len = 0;
+            for (int d = 0; d < sample->depth; d++) {
+                len += snprintf(pcs + len, sizeof(pcs) - len, "%s0x%08lx", d ? "," : "", (unsigned long)sample->pc[d]);
+            }
+            profiler_task_name(sample->task_number, name, sizeof(name));
+            ESP_LOGI(TAG, "PROF core%d;%s;%s", core, name, pcs);
+        }
+        profiler_count[core] = 0;
+    }
+}
+#endif
+
+esp_err_t resource_monitor_init() {
+#if CONFIG_RESMON_PROFILER
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        ESP_ERROR_CHECK(esp_ipc_call_blocking(core, profiler_start_on_core, NULL));
+    }
+    ESP_LOGI(TAG, "PC sampling profiler running at %d Hz per core", PROFILER_HZ);
+#endif
+    return ESP_OK;
+}
+
+void resource_monitor_get_core_load(float load[portNUM_PROCESSORS]) {
+    taskENTER_CRITICAL(&stats_lock);
+    memcpy(load, core_load, sizeof(core_load));
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+uint32_t resource_monitor_get_min_stack_free(void) {
+    taskENTER_CRITICAL(&stats_lock);
+    uint32_t stack_free = min_stack_free;
+    taskEXIT_CRITICAL(&stats_lock);
+    return stack_free;
+}
+
+int resource_monitor_get_task_usage(task_usage_t *out, int max_tasks) {
+    taskENTER_CRITICAL(&stats_lock);
+    int n = task_usage_count < max_tasks ? task_usage_count : max_tasks;
+    memcpy(out, task_usage, n * sizeof(task_usage_t));
+    taskEXIT_CRITICAL(&stats_lock);
+    return n;
+}
+
+static uint32_t previous_run_time(UBaseType_t task_number, uint32_t fallback) {
+    for (int i = 0; i < prev_count; i++) {
+        if (prev_run_time[i].task_number == task_number) {
+            return prev_run_time[i].run_time;
+        }
+    }
+    return fallback; // New task, no usage attributed this period
+}
+
+static void sample_run_time_stats(void) {
+    uint32_t total_run_time;
+    UBaseType_t n = uxTaskGetSystemState(task_status, RESMON_MAX_TASKS, &total_run_time);
+    task_status_count = n;
+    if (n == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, run-time stats skipped", RESMON_MAX_TASKS);
+        return;
+    }
+
+    // The run-time counter is wall-clock time, so a task's delta over the
+    // elapsed time is its share of one core
+    uint32_t elapsed = total_run_time - prev_total_run_time;
+    bool have_previous = prev_total_run_time != 0 && elapsed != 0;
+    task_usage_t *usage = usage_scratch;
+    float load[portNUM_PROCESSORS] = {0};
+    uint32_t stack_floor = UINT32_MAX;
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t *status = &task_status[i];
+        uint32_t delta = status->ulRunTimeCounter - previous_run_time(status->xTaskNumber, status->ulRunTimeCounter);
+        strlcpy(usage[i].name, status->pcTaskName, sizeof(usage[i].name));
+        usage[i].core = status->xCoreID == tskNO_AFFINITY ? -1 : (int)status->xCoreID;
+        usage[i].load = have_previous ? (float)delta / elapsed : 0.0f;
+        usage[i].stack_free = status->usStackHighWaterMark;
+        if (usage[i].stack_free < stack_floor) {
+            stack_floor = usage[i].stack_free;
+        }
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            if (status->xHandle == xTaskGetIdleTaskHandleForCore(core) && have_previous) {
+                load[core] = 1.0f - usage[i].load;
+                if (load[core] < 0.0f) {
+                    load[core] = 0.0f;
+                }
+            }
+        }
+        next_run_time[i].task_number = status->xTaskNumber;
+        next_run_time[i].run_time = status->ulRunTimeCounter;
+    }
+    memcpy(prev_run_time, next_run_time, n * sizeof(run_time_entry_t));
+    prev_count = n;
+    prev_total_run_time = total_run_time;
+
+    taskENTER_CRITICAL(&stats_lock);
+    memcpy(task_usage, usage, n * sizeof(task_usage_t));
+    task_usage_count = n;
+    memcpy(core_load, load, sizeof(core_load));
+    min_stack_free = stack_floor;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+static void log_task_usage(void) {
+    task_usage_t *usage = usage_scratch;
+    int n = resource_monitor_get_task_usage(usage, RESMON_MAX_TASKS);
+    float load[portNUM_PROCESSORS];
+    resource_monitor_get_core_load(load);
+
+    ESP_LOGI(TAG, "CPU load: core0 %.1f%%, core1 %.1f%%", load[0] * 100.0f, load[1] * 100.0f);
+    for (int i = 0; i < n; i++) {
+        ESP_LOGI(TAG, "  %-16s core %2d  %5.1f%%  stack free %lu B", usage[i].name, usage[i].core,
+                 usage[i].load * 100.0f, (unsigned long)usage[i].stack_free);
+    }
+}
+
+void resource_monitor_task(void *pvParameters) {
+    int periods = 0;
+    while (1) {
+        task_monitor_begin();
+        sample_run_time_stats();
+
+        if (++periods >= RESMON_LOG_PERIODS) {
+            log_task_usage();
+            task_topology_report();
+            periods = 0;
+        }
+
+#if CONFIG_RESMON_PROFILER
+        bool full = true;
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            full = full && profiler_count[core] >= PROFILER_SAMPLES;
+        }
+        if (full) {
+            profiler_dump();
+        }
+#endif
+        task_monitor_delay(RESMON_PERIOD_MS);
+    }
+    vTaskDelete(NULL);
+}
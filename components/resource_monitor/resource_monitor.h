@@ -0,0 +1,31 @@
+// components/resource_monitor/resource_monitor.h
+#ifndef RESOURCE_MONITOR_H
+#define RESOURCE_MONITOR_H
+
+#include <freertos/FreeRTOS.h>
+#include <stdint.h>
+
+// Build with CONFIG_RESMON_PROFILER=1 to enable the timer-interrupt backtrace sampler
+#ifndef CONFIG_RESMON_PROFILER
+#define CONFIG_RESMON_PROFILER 0
+#endif
+
+#define RESMON_MAX_TASKS 24
+
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+    int core;               // -1 when not pinned
+    float load;             // Share of one core over the last period, 0..1
+    uint32_t stack_free;    // Stack high-water mark, bytes never used
+} task_usage_t;
+
+esp_err_t resource_monitor_init();
+void resource_monitor_task(void *pvParameters);
+// Busy fraction per core over the last monitor period
+void resource_monitor_get_core_load(float load[portNUM_PROCESSORS]);
+// Smallest stack high-water mark across all tasks, in bytes; 0 until the first sample
+uint32_t resource_monitor_get_min_stack_free(void);
+// Copies the latest per-task snapshot, returns the number of entries
+int resource_monitor_get_task_usage(task_usage_t *out, int max_tasks);
+
+#endif // RESOURCE_MONITOR_H
@@ -0,0 +1,82 @@
+// components/task_topology/task_analysis.c
+#include "task_analysis.h"
+
+uint32_t task_analysis_release_interval(const task_model_t *task) {
+    return task->period_us ? task->period_us : task->min_interarrival_us;
+}
+
+float task_analysis_core_utilization(const task_model_t *tasks, int count, int core) {
+    float utilization = 0.0f;
+    for (int i = 0; i < count; i++) {
+        uint32_t interval = task_analysis_release_interval(&tasks[i]);
+        if (tasks[i].core == core && interval > 0) {
+            utilization += (float)tasks[i].wcet_us / interval;
+        }
+    }
+    return utilization;
+}
+
+static uint64_t deadline(const task_model_t *task) {
+    return task->deadline_us > 0 ? task->deadline_us : task_analysis_release_interval(task);
+}
+
+// Iteration R = C_i + B_i + sum over interfering j of ceil((R + J_j) / T_j) * C_j,
+// with T_j the minimum interarrival for sporadic tasks and J_j = R_j - C_j for
+// tasks that suspend, 0 otherwise. Equal-priority tasks on the same core are
+// counted as interference because FreeRTOS time-slices between them.
+static uint64_t response_time(const task_model_t *tasks, int count, int i, const task_bound_t *bounds) {
+    const task_model_t *task = &tasks[i];
+    uint64_t limit = deadline(task);
+    uint64_t response = bounds[i].response_us;
+    while (1) {
+        uint64_t next = (uint64_t)task->wcet_us + task->blocking_us;
+        for (int j = 0; j < count; j++) {
+            const task_model_t *other = &tasks[j];
+            uint32_t other_interval = task_analysis_release_interval(other);
+            if (j == i || other->core != task->core || other_interval == 0 || other->priority < task->priority) {
+                continue;
+            }
+            uint64_t jitter = other->blocking_us ? bounds[j].response_us - other->wcet_us : 0;
+            next += ((response + jitter + other_interval - 1) / other_interval) * other->wcet_us;
+        }
+        if (next == response || next > limit) {
+            return next;
+        }
+        response = next;
+    }
+}
+
+// Jitter depends on the other bounds, so passes repeat until none grows. A
+// bound past its deadline is final, which keeps the passes finite.
+void task_analysis_response_times(const task_model_t *tasks, int count, task_bound_t *bounds) {
+    for (int i = 0; i < count; i++) {
+        uint64_t response = (uint64_t)tasks[i].wcet_us + tasks[i].blocking_us;
+        bounds[i].response_us = response > UINT32_MAX ? UINT32_MAX : (uint32_t)response;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < count; i++) {
+            if (task_analysis_release_interval(&tasks[i]) == 0 || bounds[i].response_us > deadline(&tasks[i])) {
+                continue;
+            }
+            uint64_t response = response_time(tasks, count, i, bounds);
+            response = response > UINT32_MAX ? UINT32_MAX : response;
+            if (response != bounds[i].response_us) {
+                bounds[i].response_us = (uint32_t)response;
+                changed = true;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (task_analysis_release_interval(&tasks[i]) == 0) {
+            // An event task with no bound on its rate cannot be bounded either
+            bounds[i].response_us = UINT32_MAX;
+            bounds[i].schedulable = false;
+            continue;
+        }
+        bounds[i].schedulable = bounds[i].response_us <= deadline(&tasks[i]);
+    }
+}
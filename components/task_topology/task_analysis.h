@@ -0,0 +1,37 @@
+// components/task_topology/task_analysis.h
+#ifndef TASK_ANALYSIS_H
+#define TASK_ANALYSIS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Fixed-priority response-time analysis per core.
+//
+// Event-driven tasks are analysed as sporadic: released at most once per
+// min_interarrival_us, they interfere like a periodic task at that rate.
+// Time a task spends suspended within a cycle (delays, queue timeouts) adds
+// to its own response, and lets it run late, so it interferes with lower
+// priorities as a task with release jitter of its response less its WCET.
+
+typedef struct {
+    int core;
+    unsigned priority;
+    uint32_t period_us;             // 0 = event driven
+    uint32_t min_interarrival_us;   // Event-driven tasks: shortest gap between releases
+    uint32_t deadline_us;           // Response deadline from release, 0 = the period
+    uint32_t wcet_us;
+    uint32_t blocking_us;           // Longest suspension per cycle
+} task_model_t;
+
+typedef struct {
+    uint32_t response_us;   // Worst-case response bound, or the first iterate past the deadline
+    bool schedulable;       // Bound within the deadline; false for an event task with no interarrival
+} task_bound_t;
+
+// Shortest time between releases, period or minimum interarrival; 0 if unknown
+uint32_t task_analysis_release_interval(const task_model_t *task);
+// Worst-case share of the core, sporadic tasks counted at their maximum rate
+float task_analysis_core_utilization(const task_model_t *tasks, int count, int core);
+void task_analysis_response_times(const task_model_t *tasks, int count, task_bound_t *bounds);
+
+#endif // TASK_ANALYSIS_H
@@ -0,0 +1,209 @@
+// components/task_topology/task_topology.c
+#include "task_topology.h"
+#include "task_analysis.h"
+#include "esp_log.h"
+#include <esp_timer.h>
+
+static const char *TAG = "TASK_TOPOLOGY";
+
+typedef struct {
+    int64_t cycle_start_us;         // 0 when no cycle is open
+    int64_t expected_release_us;    // When the last delay should have expired
+    uint32_t max_jitter_us;
+    uint32_t max_response_us;
+    uint32_t deadline_misses;
+    uint32_t cycles;
+} task_timing_t;
+
+static const task_spec_t *task_table;
+static int task_count;
+static task_timing_t timing[TASK_TOPOLOGY_MAX_TASKS];
+static portMUX_TYPE timing_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Scratch for task_topology_report(), which runs on the resource monitor task
+static task_model_t models[TASK_TOPOLOGY_MAX_TASKS];
+static task_bound_t bounds[TASK_TOPOLOGY_MAX_TASKS];
+static task_timing_t snapshot[TASK_TOPOLOGY_MAX_TASKS];
+
+esp_err_t task_topology_create_queues(const queue_spec_t *queues, int count) {
+    esp_err_t ret = ESP_OK;
+    size_t static_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        const queue_spec_t *q = &queues[i];
+        if (q->storage) {
+            *q->handle = xQueueCreateStatic(q->length, q->item_size, q->storage, q->queue_buffer);
+            static_bytes += q->length * q->item_size + sizeof(StaticQueue_t);
+        } else {
+            *q->handle = xQueueCreate(q->length, q->item_size);
+        }
+        if (*q->handle == NULL) {
+            ESP_LOGE(TAG, "Failed to create %s queue", q->name);
+            ret = ESP_FAIL;
+        }
+    }
+    if (static_bytes) {
+        ESP_LOGI(TAG, "Static queue storage: %u B", (unsigned)static_bytes);
+    }
+    return ret;
+}
+
+esp_err_t task_topology_create_tasks(const task_spec_t *tasks, int count) {
+    if (count > TASK_TOPOLOGY_MAX_TASKS) {
+        ESP_LOGE(TAG, "Task table has %d entries, at most %d supported", count, TASK_TOPOLOGY_MAX_TASKS);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // Published before any task starts so task_monitor_begin() can find its entry
+    task_table = tasks;
+    task_count = count;
+
+    esp_err_t ret = ESP_OK;
+    size_t static_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        const task_spec_t *t = &tasks[i];
+        void *param = t->param_queue ? *t->param_queue : NULL;
+        if (t->stack_buffer) {
+            *t->handle = xTaskCreateStaticPinnedToCore(t->function, t->name, t->stack_size, param, t->priority,
+                                                       t->stack_buffer, t->tcb_buffer, t->core);
+            static_bytes += t->stack_size + sizeof(StaticTask_t);
+        } else if (xTaskCreatePinnedToCore(t->function, t->name, t->stack_size, param, t->priority,
+                                           t->handle, t->core) != pdPASS) {
+            *t->handle = NULL;
+        }
+        if (*t->handle == NULL) {
+            ESP_LOGE(TAG, "Failed to create %s", t->name);
+            ret = ESP_FAIL;
+        }
+    }
+    if (static_bytes) {
+        ESP_LOGI(TAG, "Static task stacks and TCBs: %u B", (unsigned)static_bytes);
+    }
+    return ret;
+}
+
+static int current_task_index(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < task_count; i++) {
+        if (*task_table[i].handle == self) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void task_monitor_begin(void) {
+    int i = current_task_index();
+    if (i < 0) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&timing_lock);
+    task_timing_t *t = &timing[i];
+    // A cycle left open by an early continue is simply restarted
+    if (t->expected_release_us && !t->cycle_start_us && now > t->expected_release_us) {
+        uint32_t jitter = (uint32_t)(now - t->expected_release_us);
+        if (jitter > t->max_jitter_us) {
+            t->max_jitter_us = jitter;
+        }
+    }
+    t->cycle_start_us = now;
+    taskEXIT_CRITICAL(&timing_lock);
+}
+
+void task_monitor_delay(uint32_t period_ms) {
+    int i = current_task_index();
+    if (i >= 0) {
+        const task_spec_t *spec = &task_table[i];
+        int64_t now = esp_timer_get_time();
+        bool missed = false;
+        uint32_t misses = 0;
+        uint32_t response_us = 0;
+
+        taskENTER_CRITICAL(&timing_lock);
+        task_timing_t *t = &timing[i];
+        if (t->cycle_start_us) {
+            // The first cycle has no previous delay, so it is released at begin
+            int64_t release_us = t->expected_release_us ? t->expected_release_us : t->cycle_start_us;
+            response_us = (uint32_t)(now - release_us);
+            if (response_us > t->max_response_us) {
+                t->max_response_us = response_us;
+            }
+            if (spec->deadline_ms && response_us > spec->deadline_ms * 1000) {
+                missed = true;
+                misses = ++t->deadline_misses;
+            }
+            t->cycles++;
+        }
+        t->cycle_start_us = 0;
+        t->expected_release_us = now + (int64_t)period_ms * 1000;
+        taskEXIT_CRITICAL(&timing_lock);
+
+        // Logged on the 1st, 2nd, 4th, 8th... miss to keep a persistent overrun quiet
+        if (missed && (misses & (misses - 1)) == 0) {
+            ESP_LOGW(TAG, "%s missed its %lu ms deadline (%lu us, %lu misses)", spec->name,
+                     (unsigned long)spec->deadline_ms, (unsigned long)response_us, (unsigned long)misses);
+        }
+    }
+    vTaskDelay(pdMS_TO_TICKS(period_ms));
+}
+
+uint32_t task_monitor_total_misses(void) {
+    uint32_t total = 0;
+    taskENTER_CRITICAL(&timing_lock);
+    for (int i = 0; i < task_count; i++) {
+        total += timing[i].deadline_misses;
+    }
+    taskEXIT_CRITICAL(&timing_lock);
+    return total;
+}
+
+bool task_monitor_all_cycled(void) {
+    bool cycled = task_count > 0;
+    taskENTER_CRITICAL(&timing_lock);
+    for (int i = 0; i < task_count; i++) {
+        if (task_table[i].period_ms && timing[i].cycles == 0) {
+            cycled = false;
+        }
+    }
+    taskEXIT_CRITICAL(&timing_lock);
+    return cycled;
+}
+
+void task_topology_report(void) {
+    for (int i = 0; i < task_count; i++) {
+        const task_spec_t *spec = &task_table[i];
+        models[i].core = spec->core;
+        models[i].priority = spec->priority;
+        models[i].period_us = spec->period_ms * 1000;
+        models[i].min_interarrival_us = spec->min_interarrival_ms * 1000;
+        models[i].deadline_us = spec->deadline_ms * 1000;
+        models[i].wcet_us = spec->wcet_us;
+        models[i].blocking_us = spec->blocking_us;
+    }
+    task_analysis_response_times(models, task_count, bounds);
+
+    taskENTER_CRITICAL(&timing_lock);
+    for (int i = 0; i < task_count; i++) {
+        snapshot[i] = timing[i];
+    }
+    taskEXIT_CRITICAL(&timing_lock);
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        ESP_LOGI(TAG, "Core %d budgeted utilization %.1f%%", core,
+                 task_analysis_core_utilization(models, task_count, core) * 100.0f);
+    }
+    for (int i = 0; i < task_count; i++) {
+        const task_spec_t *spec = &task_table[i];
+        if (spec->period_ms == 0) {
+            // Event-driven tasks are not instrumented, only their bound is known
+            ESP_LOGI(TAG, "  %-12s core %d prio %2u  bound %6lu us%s  (event, every >= %lu ms)", spec->name,
+                     (int)spec->core, (unsigned)spec->priority, (unsigned long)bounds[i].response_us,
+                     bounds[i].schedulable ? "" : " (!)", (unsigned long)spec->min_interarrival_ms);
+            continue;
+        }
+        ESP_LOGI(TAG, "  %-12s core %d prio %2u  bound %6lu us%s  response max %6lu us  jitter max %6lu us  misses %lu/%lu",
+                 spec->name, (int)spec->core, (unsigned)spec->priority, (unsigned long)bounds[i].response_us,
+                 bounds[i].schedulable ? "" : " (!)", (unsigned long)snapshot[i].max_response_us,
+                 (unsigned long)snapshot[i].max_jitter_us, (unsigned long)snapshot[i].deadline_misses,
+                 (unsigned long)snapshot[i].cycles);
+    }
+}
@@ -0,0 +1,55 @@
+// components/task_topology/task_topology.h
+#ifndef TASK_TOPOLOGY_H
+#define TASK_TOPOLOGY_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TASK_TOPOLOGY_MAX_TASKS 16
+
+typedef struct {
+    const char *name;
+    QueueHandle_t *handle;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    uint8_t *storage;               // Static backing, or NULL to allocate
+    StaticQueue_t *queue_buffer;
+} queue_spec_t;
+
+typedef struct {
+    const char *name;
+    TaskFunction_t function;
+    uint32_t stack_size;            // Bytes
+    UBaseType_t priority;
+    BaseType_t core;
+    uint32_t period_ms;             // Nominal period, 0 for event-driven tasks
+    uint32_t min_interarrival_ms;   // Event-driven tasks: shortest gap between activations
+    uint32_t deadline_ms;           // Response deadline from release
+    uint32_t wcet_us;               // CPU budget per cycle, used by the analysis
+    uint32_t blocking_us;           // Longest suspension per cycle, used by the analysis
+    QueueHandle_t *param_queue;     // Queue passed as the task parameter, or NULL
+    TaskHandle_t *handle;
+    StackType_t *stack_buffer;      // Static backing, or NULL to allocate
+    StaticTask_t *tcb_buffer;
+} task_spec_t;
+
+esp_err_t task_topology_create_queues(const queue_spec_t *queues, int count);
+// Creates every task in the table and fails if any one of them failed
+esp_err_t task_topology_create_tasks(const task_spec_t *tasks, int count);
+// Logs per-core utilization, response-time bounds and the measured timing of each task
+void task_topology_report(void);
+
+// Periodic tasks bracket each cycle with these. A cycle is released when the
+// previous delay expires; response time runs from that release to the next
+// delay and is what the deadline is checked against. Release jitter is how
+// late begin ran after the release.
+void task_monitor_begin(void);
+void task_monitor_delay(uint32_t period_ms);
+uint32_t task_monitor_total_misses(void);
+// True once every periodic task in the table has completed a cycle
+bool task_monitor_all_cycled(void);
+
+#endif // TASK_TOPOLOGY_H
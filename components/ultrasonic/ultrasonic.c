@@ -2,11 +2,14 @@
 #include "ultrasonic.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
+#include "power_management.h"
+#include "task_topology.h"
 #include <sys/time.h>
 
 static const char *TAG = "ULTRASONIC";
 
 #define NUM_SENSORS 7
+#define ULTRASONIC_ECHO_TIMEOUT_US 20000    // Trigger to end of echo, about 3.4 m; the WCET in task_table.h covers one per sensor
 
 static const ultrasonic_sensor_config_t sensors[NUM_SENSORS] = {
     {GPIO_NUM_16, GPIO_NUM_17, SENSOR_FORWARD},
@@ -45,8 +48,9 @@ static bool get_sensor_reading(const ultrasonic_sensor_config_t *sensor, float *
     vTaskDelay(pdMS_TO_TICKS(10));
     gpio_set_level(sensor->trigger_pin, 0);
 
+    // Busy-waits on the echo, bounded from the trigger
     int64_t start_time = esp_timer_get_time();
-    int64_t timeout_time = start_time + 10000;
+    int64_t timeout_time = start_time + ULTRASONIC_ECHO_TIMEOUT_US;
 
     while (gpio_get_level(sensor->echo_pin) == 0) {
         if (esp_timer_get_time() > timeout_time) return false;
@@ -54,7 +58,7 @@ static bool get_sensor_reading(const ultrasonic_sensor_config_t *sensor, float *
 
     int64_t echo_start_time = esp_timer_get_time();
     while (gpio_get_level(sensor->echo_pin) == 1) {
-        if (esp_timer_get_time() > timeout_time * 2) return false;
+        if (esp_timer_get_time() > timeout_time) return false;
     }
     int64_t echo_end_time = esp_timer_get_time();
 
@@ -66,6 +70,7 @@ static bool get_sensor_reading(const ultrasonic_sensor_config_t *sensor, float *
 void ultrasonic_task(void *pvParameters) {
     QueueHandle_t ultrasonic_queue = (QueueHandle_t)pvParameters;
     while (1) {
+        task_monitor_begin();
         for (int i = 0; i < NUM_SENSORS; i++) {
             float distance;
             if (get_sensor_reading(&sensors[i], &distance)) {
@@ -87,7 +92,7 @@ void ultrasonic_task(void *pvParameters) {
                 xQueueSend(ultrasonic_queue, &error_data, 0);
             }
         }
-        vTaskDelay(pdMS_TO_TICKS(50));
+        task_monitor_delay(power_management_get_rates().ultrasonic_period_ms);
     }
     vTaskDelete(NULL);
 }
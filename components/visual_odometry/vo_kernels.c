@@ -0,0 +1,82 @@
+// components/visual_odometry/vo_kernels.c
+#include "vo_kernels.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define FEATURE_THRESHOLD 50
+#define MIN_MATCH_DISTANCE_SQ 100
+
+int vo_detect_features(const uint8_t *gray_frame, feature_point_t *features, int max_features) {
+    int feature_count = 0;
+    for (int y = 1; y < VO_IMAGE_HEIGHT - 1; y++) {
+        for (int x = 1; x < VO_IMAGE_WIDTH - 1; x++) {
+            int center_pixel = gray_frame[y * VO_IMAGE_WIDTH + x];
+            if (abs(center_pixel - gray_frame[(y - 1) * VO_IMAGE_WIDTH + x]) > FEATURE_THRESHOLD ||
+                abs(center_pixel - gray_frame[(y + 1) * VO_IMAGE_WIDTH + x]) > FEATURE_THRESHOLD ||
+                abs(center_pixel - gray_frame[y * VO_IMAGE_WIDTH + (x - 1)]) > FEATURE_THRESHOLD ||
+                abs(center_pixel - gray_frame[y * VO_IMAGE_WIDTH + (x + 1)]) > FEATURE_THRESHOLD) {
+                if (feature_count < max_features) {
+                    features[feature_count].x = x;
+                    features[feature_count].y = y;
+                    feature_count++;
+                }
+            }
+        }
+    }
+    return feature_count;
+}
+
+int vo_match_features(const feature_point_t *prev_features, int prev_count,
+                      const feature_point_t *curr_features, int curr_count, int *matches) {
+    int match_count = 0;
+    for (int i = 0; i < curr_count; i++) {
+        int best_match_index = -1;
+        int min_distance_sq = MIN_MATCH_DISTANCE_SQ;
+        for (int j = 0; j < prev_count; j++) {
+            int dx = curr_features[i].x - prev_features[j].x;
+            int dy = curr_features[i].y - prev_features[j].y;
+            int distance_sq = dx * dx + dy * dy;
+            if (distance_sq < min_distance_sq) {
+                min_distance_sq = distance_sq;
+                best_match_index = j;
+            }
+        }
+        if (best_match_index != -1) {
+            matches[match_count * 2] = best_match_index;
+            matches[match_count * 2 + 1] = i;
+            match_count++;
+        }
+    }
+    return match_count;
+}
+
+// Basic motion estimation including rotation (simplified approach)
+bool vo_estimate_motion(const feature_point_t *prev_features, const feature_point_t *curr_features,
+                        const int *matches, int match_count, vo_motion_t *motion) {
+    motion->dx = 0;
+    motion->dy = 0;
+    motion->yaw = 0;
+    if (match_count < VO_MIN_MATCHES) {
+        return false;
+    }
+
+    float avg_dx = 0, avg_dy = 0;
+    float avg_rotation = 0; // Simplified rotation estimation
+    for (int i = 0; i < match_count; i++) {
+        int prev_index = matches[i * 2];
+        int curr_index = matches[i * 2 + 1];
+
+        avg_dx += (float)(curr_features[curr_index].x - prev_features[prev_index].x);
+        avg_dy += (float)(curr_features[curr_index].y - prev_features[prev_index].y);
+
+        // Very simplified rotation estimation: change in angle
+        float prev_angle = atan2(prev_features[prev_index].y - (VO_IMAGE_HEIGHT / 2.0f), prev_features[prev_index].x - (VO_IMAGE_WIDTH / 2.0f));
+        float curr_angle = atan2(curr_features[curr_index].y - (VO_IMAGE_HEIGHT / 2.0f), curr_features[curr_index].x - (VO_IMAGE_WIDTH / 2.0f));
+        avg_rotation += curr_angle - prev_angle;
+    }
+
+    motion->dx = avg_dx / match_count;
+    motion->dy = avg_dy / match_count;
+    motion->yaw = avg_rotation / match_count;
+    return true;
+}
@@ -0,0 +1,33 @@
+// components/visual_odometry/vo_kernels.h
+#ifndef VO_KERNELS_H
+#define VO_KERNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Per-frame visual odometry kernels: corner detection, feature matching and
+// motion estimation on the VO_IMAGE_WIDTH x VO_IMAGE_HEIGHT grayscale plane.
+
+#define VO_IMAGE_WIDTH  80
+#define VO_IMAGE_HEIGHT 60
+#define VO_MAX_FEATURES 50
+#define VO_MIN_MATCHES 5            // Fewer matches give no usable motion estimate
+
+typedef struct {
+    int x, y;
+} feature_point_t;
+
+typedef struct {
+    float dx, dy;                   // Mean feature translation, pixels
+    float yaw;                      // Mean rotation about the image center, radians
+} vo_motion_t;
+
+int vo_detect_features(const uint8_t *gray_frame, feature_point_t *features, int max_features);
+// Nearest-neighbour matching; matches holds (prev index, curr index) pairs
+int vo_match_features(const feature_point_t *prev_features, int prev_count,
+                      const feature_point_t *curr_features, int curr_count, int *matches);
+// Returns false when there are too few matches for an estimate
+bool vo_estimate_motion(const feature_point_t *prev_features, const feature_point_t *curr_features,
+                        const int *matches, int match_count, vo_motion_t *motion);
+
+#endif // VO_KERNELS_H
@@ -19,9 +19,56 @@
 #include "camera.h"
 #include "mavlink_handler.h"
 #include "visual_odometry.h"
+#include "i2c_bus.h"
+#include "task_topology.h"
+#include "task_table.h"
 
 static const char *TAG = "MAIN";
 
+// Build with CONFIG_DRONE_STATIC_ALLOCATION=1 to give every task stack, TCB and
+// queue storage a static backing instead of allocating them from the heap.
+// tools/memory_map.py lists the resulting static usage per RAM section.
+#ifndef CONFIG_DRONE_STATIC_ALLOCATION
+#define CONFIG_DRONE_STATIC_ALLOCATION 0
+#endif
+
+// Task stack sizes (bytes)
+#define QR_TASK_STACK            4096
+#define ULTRASONIC_TASK_STACK    4096
+#define COMMUNICATION_TASK_STACK 4096
+#define NAVIGATION_TASK_STACK    4096
+#define POWER_TASK_STACK         2048
+#define MAGNET_TASK_STACK        2048
+#define LOGGING_TASK_STACK       4096
+#define RESMON_TASK_STACK        3072
+#define VO_TASK_STACK            8192
+#define I2C_BUS_TASK_STACK       3072
+
+// Queue depths
+#define ULTRASONIC_QUEUE_LEN     10
+#define QR_CODE_QUEUE_LEN        5
+#define COMMAND_QUEUE_LEN        10
+#define TELEMETRY_QUEUE_LEN      10
+#define LOGGING_QUEUE_LEN        20
+#define VO_QUEUE_LEN             5
+
+// How long a freshly installed OTA image runs before it is confirmed
+#define OTA_HEALTH_CHECK_MS      30000
+
+#if CONFIG_DRONE_STATIC_ALLOCATION
+#define DEFINE_STATIC_TASK(name, stack_size) \
+    static StackType_t name##_stack[stack_size]; \
+    static StaticTask_t name##_tcb
+#define DEFINE_STATIC_QUEUE(name, length, item_type) \
+    static uint8_t name##_storage[(length) * sizeof(item_type)]; \
+    static StaticQueue_t name##_struct
+#define TASK_BUFFERS(name) .stack_buffer = name##_stack, .tcb_buffer = &name##_tcb
+#define QUEUE_BUFFERS(name) .storage = name##_storage, .queue_buffer = &name##_struct
+#else
+#define TASK_BUFFERS(name) .stack_buffer = NULL
+#define QUEUE_BUFFERS(name) .storage = NULL
+#endif
+
 // Task handles
 TaskHandle_t qr_code_task_handle;
 TaskHandle_t ultrasonic_task_handle;
@@ -32,6 +79,7 @@ TaskHandle_t magnet_control_task_handle;
 TaskHandle_t logging_task_handle;
 TaskHandle_t resource_monitor_task_handle;
 TaskHandle_t visual_odometry_task_handle;
+TaskHandle_t i2c_bus_task_handle;
 
 // Queue handles for inter-task communication
 QueueHandle_t ultrasonic_data_queue;
@@ -44,6 +92,43 @@ QueueHandle_t visual_odometry_queue; // For passing VO data to navigation
 // Semaphore for I2C bus access
 SemaphoreHandle_t i2c_mutex;
 
+#if CONFIG_DRONE_STATIC_ALLOCATION
+#define TASK_STATIC_BUFFERS(id, task_name, stack, prio, cpu, period, interarrival, deadline, wcet, blocking, queue) \
+    DEFINE_STATIC_TASK(id, stack);
+TASK_TABLE(TASK_STATIC_BUFFERS)
+
+DEFINE_STATIC_QUEUE(ultrasonic_data_queue, ULTRASONIC_QUEUE_LEN, ultrasonic_data_t);
+DEFINE_STATIC_QUEUE(qr_code_data_queue, QR_CODE_QUEUE_LEN, qr_code_result_t);
+DEFINE_STATIC_QUEUE(command_queue, COMMAND_QUEUE_LEN, command_t);
+DEFINE_STATIC_QUEUE(telemetry_queue, TELEMETRY_QUEUE_LEN, telemetry_data_t);
+DEFINE_STATIC_QUEUE(logging_queue, LOGGING_QUEUE_LEN, log_message_t);
+DEFINE_STATIC_QUEUE(visual_odometry_queue, VO_QUEUE_LEN, vo_data_t);
+static StaticSemaphore_t i2c_mutex_buffer;
+
+#endif
+
+#define QUEUE_SPEC(var, len, item_type) \
+    { .name = #var, .handle = &var, .length = len, .item_size = sizeof(item_type), QUEUE_BUFFERS(var) }
+
+static const queue_spec_t queue_table[] = {
+    QUEUE_SPEC(ultrasonic_data_queue, ULTRASONIC_QUEUE_LEN, ultrasonic_data_t),
+    QUEUE_SPEC(qr_code_data_queue, QR_CODE_QUEUE_LEN, qr_code_result_t),
+    QUEUE_SPEC(command_queue, COMMAND_QUEUE_LEN, command_t),
+    QUEUE_SPEC(telemetry_queue, TELEMETRY_QUEUE_LEN, telemetry_data_t),
+    QUEUE_SPEC(logging_queue, LOGGING_QUEUE_LEN, log_message_t),
+    QUEUE_SPEC(visual_odometry_queue, VO_QUEUE_LEN, vo_data_t), // Visual odometry data for navigation
+};
+
+// Task topology, see task_table.h
+#define TASK_SPEC(id, task_name, stack, prio, cpu, period, interarrival, deadline, wcet, blocking, queue) \
+    { .name = task_name, .function = id, .stack_size = stack, .priority = prio, .core = cpu, \
+      .period_ms = period, .min_interarrival_ms = interarrival, .deadline_ms = deadline, .wcet_us = wcet, \
+      .blocking_us = blocking, .param_queue = queue, .handle = &id##_handle, TASK_BUFFERS(id) },
+
+static const task_spec_t task_table[] = {
+    TASK_TABLE(TASK_SPEC)
+};
+
 void app_main() {
     ESP_LOGI(TAG, "Enhanced Hybrid Drone Architecture (ArduPilot Edition) - ESP32-S3 Startup");
 
@@ -66,23 +151,24 @@ void app_main() {
     };
     ESP_ERROR_CHECK(i2c_param_config(I2C_NUM_0, &conf));
     ESP_ERROR_CHECK(i2c_driver_install(I2C_NUM_0, conf.mode, 0, 0, 0));
+#if CONFIG_DRONE_STATIC_ALLOCATION
+    i2c_mutex = xSemaphoreCreateMutexStatic(&i2c_mutex_buffer);
+#else
     i2c_mutex = xSemaphoreCreateMutex();
+#endif
+    // Peripheral traffic goes through the bus manager task. magnet_control
+    // still drives the port directly, so both sides hold i2c_mutex per access.
+    ESP_ERROR_CHECK(i2c_bus_init(I2C_NUM_0, i2c_mutex));
 
     // Initialize Queues
-    ultrasonic_data_queue = xQueueCreate(10, sizeof(ultrasonic_data_t));
-    qr_code_data_queue = xQueueCreate(5, sizeof(qr_code_result_t));
-    command_queue = xQueueCreate(10, sizeof(command_t));
-    telemetry_queue = xQueueCreate(10, sizeof(telemetry_data_t));
-    logging_queue = xQueueCreate(20, sizeof(log_message_t));
-    visual_odometry_queue = xQueueCreate(5, sizeof(vo_data_t)); // Queue for visual odometry data
-
-    if (ultrasonic_data_queue == NULL || qr_code_data_queue == NULL || command_queue == NULL || telemetry_queue == NULL || logging_queue == NULL || visual_odometry_queue == NULL) {
+    if (task_topology_create_queues(queue_table, sizeof(queue_table) / sizeof(queue_table[0])) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create queues");
         esp_restart(); // Critical failure, restart
     }
 
     // Initialize Subsystems
-    if (camera_init() != ESP_OK) {
+    bool camera_ok = camera_init() == ESP_OK;
+    if (!camera_ok) {
         ESP_LOGE(TAG, "Camera initialization failed");
         // Proceed without camera, some features might be disabled
     }
@@ -96,41 +182,22 @@ void app_main() {
     resource_monitor_init();
     ota_update_init();
     mavlink_init(); // Initialize MAVLink communication
+    visual_odometry_init();
 
     // Create Tasks
-    BaseType_t result;
-
-    result = xTaskCreatePinnedToCore(qr_code_task, "QR_Task", 4096, qr_code_data_queue, 5, &qr_code_task_handle, APP_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create QR Code Task");
-
-    result = xTaskCreatePinnedToCore(ultrasonic_task, "Ultra_Task", 4096, ultrasonic_data_queue, 4, &ultrasonic_task_handle, APP_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create Ultrasonic Task");
-
-    result = xTaskCreatePinnedToCore(communication_task, "Comm_Task", 4096, NULL, 3, &communication_task_handle, PRO_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create Communication Task");
-
-    result = xTaskCreatePinnedToCore(navigation_task, "Nav_Task", 4096, NULL, 4, &navigation_task_handle, APP_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create Navigation Task");
-
-    result = xTaskCreatePinnedToCore(power_management_task, "Power_Task", 2048, NULL, 2, &power_management_task_handle, PRO_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create Power Management Task");
-
-    result = xTaskCreatePinnedToCore(magnet_control_task, "Magnet_Task", 2048, NULL, 3, &magnet_control_task_handle, APP_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create Magnet Control Task");
-
-    result = xTaskCreatePinnedToCore(logging_task, "Log_Task", 4096, logging_queue, 1, &logging_task_handle, PRO_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create Logging Task");
-
-    result = xTaskCreatePinnedToCore(resource_monitor_task, "ResMon_Task", 2048, NULL, 1, &resource_monitor_task_handle, PRO_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create Resource Monitor Task");
-
-    result = xTaskCreatePinnedToCore(visual_odometry_task, "VO_Task", 8192, visual_odometry_queue, 4, &visual_odometry_task_handle, APP_CPU_NUM);
-    if (result != pdPASS) ESP_LOGE(TAG, "Failed to create Visual Odometry Task");
-
-    if (result == pdPASS) {
+    ret = task_topology_create_tasks(task_table, sizeof(task_table) / sizeof(task_table[0]));
+    if (ret == ESP_OK) {
         ESP_LOGI(TAG, "All core tasks created successfully.");
     } else {
         ESP_LOGE(TAG, "Task creation failed, system might be unstable.");
     }
+    task_topology_report();
+
+    // A new OTA image is kept only once it has run every periodic task;
+    // resetting before this point boots the previous image again
+    if (ota_update_pending_verify()) {
+        vTaskDelay(pdMS_TO_TICKS(OTA_HEALTH_CHECK_MS));
+        ota_update_confirm_image(ret == ESP_OK && camera_ok && task_monitor_all_cycled());
+    }
 }
 
@@ -0,0 +1,40 @@
+// task_table.h - The firmware task set
+//
+// One TASK() row per task, expanded by main.c into the task_spec_t table and
+// by the host tests into task_analysis models, so the deadline analysis runs
+// on exactly what the firmware creates:
+//
+//   TASK(id, name, stack, priority, core, period_ms, min_interarrival_ms, deadline_ms, wcet_us, blocking_us, param_queue)
+//
+// id is the task function; main.c also derives the handle (id##_handle) and
+// static buffers from it. Periods are the nominal rates at full power, the
+// governor stretches them on low battery. A period of 0 marks an event-driven
+// task, analysed at its minimum interarrival time. WCET budgets are per-cycle
+// CPU time, busy-waits included, and should be revisited against the measured
+// response max that task_topology_report() prints. blocking_us is the longest
+// a cycle spends suspended: vTaskDelay() calls and queue timeouts inside it.
+// Waits for a camera frame are not counted.
+#ifndef TASK_TABLE_H
+#define TASK_TABLE_H
+
+#define TASK_TABLE(TASK) \
+    /* Highest priority so queued magnet commands reach the bus without delay. */ \
+    /* Woken per transaction: baro and mag at 100 Hz, gauge, log and magnet. */ \
+    TASK(i2c_bus_task, "I2C_Bus_Task", I2C_BUS_TASK_STACK, 6, PRO_CPU_NUM, 0, 2, 2, 500, 0, NULL) \
+    TASK(qr_code_task, "QR_Task", QR_TASK_STACK, 5, APP_CPU_NUM, 50, 0, 100, 20000, 0, &qr_code_data_queue) \
+    /* Per sensor: polls the echo for up to ULTRASONIC_ECHO_TIMEOUT_US (20 ms), */ \
+    /* sleeps 2 + 10 ms around the trigger and may wait 10 ms on a full queue */ \
+    TASK(ultrasonic_task, "Ultra_Task", ULTRASONIC_TASK_STACK, 4, APP_CPU_NUM, 50, 0, 150, 141000, 154000, &ultrasonic_data_queue) \
+    TASK(communication_task, "Comm_Task", COMMUNICATION_TASK_STACK, 3, PRO_CPU_NUM, 1000, 0, 200, 5000, 0, NULL) \
+    /* Waits up to 10 ms on each of the ultrasonic and VO queues */ \
+    TASK(navigation_task, "Nav_Task", NAVIGATION_TASK_STACK, 6, APP_CPU_NUM, 10, 0, 30, 1000, 20000, NULL) \
+    TASK(power_management_task, "Power_Task", POWER_TASK_STACK, 2, PRO_CPU_NUM, 500, 0, 500, 500, 0, NULL) \
+    /* Ground station commands, rate limited by the command link */ \
+    TASK(magnet_control_task, "Magnet_Task", MAGNET_TASK_STACK, 3, APP_CPU_NUM, 0, 100, 100, 200, 0, NULL) \
+    /* Drains the log queue; a burst beyond this rate waits in the queue */ \
+    TASK(logging_task, "Log_Task", LOGGING_TASK_STACK, 1, PRO_CPU_NUM, 0, 50, 50, 1000, 0, &logging_queue) \
+    TASK(resource_monitor_task, "ResMon_Task", RESMON_TASK_STACK, 1, PRO_CPU_NUM, 1000, 0, 1000, 2000, 0, NULL) \
+    /* May wait 10 ms on a full VO queue */ \
+    TASK(visual_odometry_task, "VO_Task", VO_TASK_STACK, 4, APP_CPU_NUM, 50, 0, 100, 15000, 10000, &visual_odometry_queue)
+
+#endif // TASK_TABLE_H
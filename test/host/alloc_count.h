@@ -0,0 +1,9 @@
+// test/host/alloc_count.h
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+// Heap calls (malloc, calloc, realloc) made by the process so far. Linking
+// alloc_count.c interposes the glibc allocator to count them.
+unsigned long alloc_count(void);
+
+#endif // ALLOC_COUNT_H
@@ -0,0 +1,287 @@
+// test/host/i2c_bus_sim.c - Queueing latency of the I2C bus manager on a fake bus
+//
+// Drives i2c_bus_core against a simulated 400 kHz bus in virtual time. Sensor
+// reads, the battery gauge and the flight log arrive periodically at low
+// priority, magnet commands at random at high priority. Each scenario runs
+// twice: with the manager's preemption between ops, and with whole lists
+// holding the bus, which is how callers behaved under the old i2c_mutex.
+// Queueing latency (submit to start) is reported per priority class.
+#include "test_util.h"
+#include "i2c_bus_core.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_DURATION_US (60 * 1000000LL)
+#define SIM_MAX_SAMPLES 100000
+
+// Timing model: 9 bit times per byte at 400 kHz plus a fixed driver cost per
+// op. The battery gauge stretches the clock on every read.
+#define BUS_BYTE_US 22.5
+#define BUS_OP_OVERHEAD_US 15
+#define GAUGE_ADDR 0x55
+#define GAUGE_STRETCH_US 1000
+
+typedef struct {
+    const char *name;
+    i2c_bus_transaction_t txn;
+    int64_t period_us;          // 0: random arrivals between min and max
+    int64_t min_gap_us;
+    int64_t max_gap_us;
+    int64_t next_us;
+} sim_source_t;
+
+typedef struct {
+    i2c_bus_transaction_t items[I2C_BUS_LOW_QUEUE_LEN];
+    int head;
+    int count;
+    int capacity;
+} sim_queue_t;
+
+typedef struct {
+    uint32_t latency_us[I2C_BUS_PRIO_COUNT][SIM_MAX_SAMPLES];
+    int samples[I2C_BUS_PRIO_COUNT];
+    int submitted[I2C_BUS_PRIO_COUNT];
+    int coalesced[I2C_BUS_PRIO_COUNT];
+    int dropped[I2C_BUS_PRIO_COUNT];
+    int64_t busy_us;
+    uint32_t max_op_us;
+    uint32_t max_high_op_us;
+} sim_stats_t;
+
+static const uint8_t reg_addr[1] = { 0x00 };
+static const uint8_t magnet_cmd[2] = { 0x01, 0xFF };
+static const uint8_t log_page[34];
+static uint8_t read_scratch[8];
+
+static int64_t sim_clock_us;
+static sim_queue_t queues[I2C_BUS_PRIO_COUNT];
+static sim_source_t *sources;
+static int source_count;
+static sim_stats_t stats;
+static bool preempt_between_ops;
+static int lists_in_progress;
+static uint32_t rng;
+static i2c_bus_core_t core;
+
+static uint32_t op_duration_us(const i2c_bus_op_t *op) {
+    double bytes = 0;
+    if (op->write_len) {
+        bytes += 1 + op->write_len;
+    }
+    if (op->read_len) {
+        bytes += 1 + op->read_len;
+    }
+    uint32_t us = BUS_OP_OVERHEAD_US + (uint32_t)(bytes * BUS_BYTE_US + 0.5);
+    if (op->addr == GAUGE_ADDR && op->read_len) {
+        us += GAUGE_STRETCH_US;
+    }
+    return us;
+}
+
+static void submit(sim_source_t *src) {
+    i2c_bus_transaction_t txn = src->txn;
+    txn.submit_time_us = src->next_us;
+    stats.submitted[txn.priority]++;
+    // Same path as i2c_bus_submit() with a zero timeout
+    if (!i2c_bus_core_claim_key(&core, txn.coalesce_key)) {
+        stats.coalesced[txn.priority]++;
+        return;
+    }
+    sim_queue_t *q = &queues[txn.priority];
+    if (q->count == q->capacity) {
+        i2c_bus_core_drop_key(&core, txn.coalesce_key);
+        stats.dropped[txn.priority]++;
+        return;
+    }
+    q->items[(q->head + q->count++) % q->capacity] = txn;
+}
+
+static int64_t next_gap_us(const sim_source_t *src) {
+    if (src->period_us) {
+        return src->period_us;
+    }
+    return src->min_gap_us + test_rand(&rng) % (uint32_t)(src->max_gap_us - src->min_gap_us);
+}
+
+// Submits everything that arrived up to the current time, in arrival order
+static void deliver_arrivals(void) {
+    while (1) {
+        sim_source_t *first = NULL;
+        for (int i = 0; i < source_count; i++) {
+            if (sources[i].next_us <= sim_clock_us && (!first || sources[i].next_us < first->next_us)) {
+                first = &sources[i];
+            }
+        }
+        if (!first) {
+            return;
+        }
+        submit(first);
+        first->next_us += next_gap_us(first);
+    }
+}
+
+static int64_t next_arrival_us(void) {
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < source_count; i++) {
+        if (sources[i].next_us < next) {
+            next = sources[i].next_us;
+        }
+    }
+    return next;
+}
+
+static bool sim_receive(i2c_bus_priority_t priority, i2c_bus_transaction_t *txn) {
+    // Without preemption a list keeps the bus until it completes, as with a mutex held around it
+    if (!preempt_between_ops && lists_in_progress) {
+        return false;
+    }
+    sim_queue_t *q = &queues[priority];
+    if (!q->count) {
+        return false;
+    }
+    *txn = q->items[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+    return true;
+}
+
+static int sim_execute_op(const i2c_bus_op_t *op) {
+    uint32_t us = op_duration_us(op);
+    sim_clock_us += us;
+    stats.busy_us += us;
+    deliver_arrivals();
+    return 0;
+}
+
+static void sim_started(const i2c_bus_transaction_t *txn) {
+    int prio = txn->priority;
+    if (stats.samples[prio] < SIM_MAX_SAMPLES) {
+        stats.latency_us[prio][stats.samples[prio]++] = (uint32_t)(sim_clock_us - txn->submit_time_us);
+    }
+    lists_in_progress++;
+}
+
+static void sim_complete(const i2c_bus_transaction_t *txn, int result) {
+    lists_in_progress--;
+}
+
+static const i2c_bus_port_t sim_port = {
+    .receive = sim_receive,
+    .execute_op = sim_execute_op,
+    .started = sim_started,
+    .complete = sim_complete,
+};
+
+static void run(sim_source_t *srcs, int count, bool preempt) {
+    memset(&stats, 0, sizeof(stats));
+    memset(queues, 0, sizeof(queues));
+    queues[I2C_BUS_PRIO_HIGH].capacity = I2C_BUS_HIGH_QUEUE_LEN;
+    queues[I2C_BUS_PRIO_LOW].capacity = I2C_BUS_LOW_QUEUE_LEN;
+    sources = srcs;
+    source_count = count;
+    preempt_between_ops = preempt;
+    lists_in_progress = 0;
+    rng = 0x1F2E3D4C;
+    sim_clock_us = 0;
+    i2c_bus_core_init(&core, &sim_port);
+
+    for (int i = 0; i < count; i++) {
+        srcs[i].next_us = next_gap_us(&srcs[i]);
+        for (int op = 0; op < srcs[i].txn.op_count; op++) {
+            uint32_t us = op_duration_us(&srcs[i].txn.ops[op]);
+            if (us > stats.max_op_us) {
+                stats.max_op_us = us;
+            }
+            if (srcs[i].txn.priority == I2C_BUS_PRIO_HIGH && us > stats.max_high_op_us) {
+                stats.max_high_op_us = us;
+            }
+        }
+    }
+    while (sim_clock_us < SIM_DURATION_US) {
+        deliver_arrivals();
+        if (!i2c_bus_core_run_next(&core)) {
+            sim_clock_us = next_arrival_us();
+        }
+    }
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(int prio, int pct) {
+    int n = stats.samples[prio];
+    if (!n) {
+        return 0;
+    }
+    qsort(stats.latency_us[prio], n, sizeof(uint32_t), compare_u32);
+    return stats.latency_us[prio][(n - 1) * pct / 100];
+}
+
+static void report(const char *scenario, bool preempt) {
+    static const char *prio_names[I2C_BUS_PRIO_COUNT] = { "high", "low" };
+    printf("%-10s %-8s bus %4.1f%%", scenario, preempt ? "manager" : "mutex", 100.0 * stats.busy_us / sim_clock_us);
+    for (int p = 0; p < I2C_BUS_PRIO_COUNT; p++) {
+        printf("  %s p50/p99/max %5u/%5u/%5u us (%d run, %d coalesced, %d dropped)", prio_names[p], percentile(p, 50),
+               percentile(p, 99), percentile(p, 100), stats.samples[p], stats.coalesced[p], stats.dropped[p]);
+    }
+    printf("\n");
+}
+
+#define OP_READ(a, n) { .addr = (a), .write_buf = reg_addr, .write_len = 1, .read_buf = read_scratch, .read_len = (n) }
+#define OP_WRITE(a, buf) { .addr = (a), .write_buf = (buf), .write_len = sizeof(buf) }
+#define PERIODIC(source, prio, key, period, ...) \
+    { .name = (source), .txn = { .ops = { __VA_ARGS__ }, .op_count = COUNT(((i2c_bus_op_t[]){ __VA_ARGS__ })), \
+      .priority = (prio), .coalesce_key = (key) }, .period_us = (period) }
+#define RANDOM(source, prio, min_gap, max_gap, ...) \
+    { .name = (source), .txn = { .ops = { __VA_ARGS__ }, .op_count = COUNT(((i2c_bus_op_t[]){ __VA_ARGS__ })), \
+      .priority = (prio) }, .min_gap_us = (min_gap), .max_gap_us = (max_gap) }
+#define COUNT(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+#define GAUGE_READS OP_READ(GAUGE_ADDR, 2), OP_READ(GAUGE_ADDR, 2), OP_READ(GAUGE_ADDR, 2), OP_READ(GAUGE_ADDR, 2)
+
+static sim_source_t nominal[] = {
+    PERIODIC("baro", I2C_BUS_PRIO_LOW, 1, 10000, OP_READ(0x77, 6)),
+    PERIODIC("mag", I2C_BUS_PRIO_LOW, 2, 10000, OP_READ(0x1E, 6)),
+    PERIODIC("gauge", I2C_BUS_PRIO_LOW, 3, 100000, GAUGE_READS),
+    PERIODIC("log", I2C_BUS_PRIO_LOW, 0, 50000, OP_WRITE(0x50, log_page)),
+    RANDOM("magnet", I2C_BUS_PRIO_HIGH, 5000, 35000, OP_WRITE(0x20, magnet_cmd)),
+};
+
+// Sensor reads at 1 kHz and the gauge at 100 Hz: more work than the bus can carry
+static sim_source_t overload[] = {
+    PERIODIC("baro", I2C_BUS_PRIO_LOW, 1, 1000, OP_READ(0x77, 6)),
+    PERIODIC("mag", I2C_BUS_PRIO_LOW, 2, 1000, OP_READ(0x1E, 6)),
+    PERIODIC("gauge", I2C_BUS_PRIO_LOW, 3, 10000, GAUGE_READS),
+    PERIODIC("log", I2C_BUS_PRIO_LOW, 0, 50000, OP_WRITE(0x50, log_page)),
+    RANDOM("magnet", I2C_BUS_PRIO_HIGH, 5000, 35000, OP_WRITE(0x20, magnet_cmd)),
+};
+
+int main(void) {
+    // A magnet command waits for at most the op on the bus plus commands queued ahead of it
+    run(nominal, COUNT(nominal), true);
+    report("nominal", true);
+    uint32_t high_bound_us = stats.max_op_us + (I2C_BUS_HIGH_QUEUE_LEN - 1) * stats.max_high_op_us;
+    uint32_t manager_high_max = percentile(I2C_BUS_PRIO_HIGH, 100);
+    CHECK(manager_high_max <= high_bound_us);
+    CHECK(stats.dropped[I2C_BUS_PRIO_HIGH] == 0 && stats.dropped[I2C_BUS_PRIO_LOW] == 0);
+    CHECK(stats.coalesced[I2C_BUS_PRIO_LOW] == 0);
+
+    run(nominal, COUNT(nominal), false);
+    report("nominal", false);
+    CHECK(percentile(I2C_BUS_PRIO_HIGH, 100) > manager_high_max);
+
+    // Coalescing keeps the low queue from filling, so nothing is dropped and
+    // magnet commands keep the same bound
+    run(overload, COUNT(overload), true);
+    report("overload", true);
+    CHECK(percentile(I2C_BUS_PRIO_HIGH, 100) <= high_bound_us);
+    CHECK(stats.coalesced[I2C_BUS_PRIO_LOW] > 0);
+    CHECK(stats.dropped[I2C_BUS_PRIO_HIGH] == 0 && stats.dropped[I2C_BUS_PRIO_LOW] == 0);
+
+    run(overload, COUNT(overload), false);
+    report("overload", false);
+
+    return TEST_RESULT();
+}
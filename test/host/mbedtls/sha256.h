@@ -0,0 +1,25 @@
+// test/host/mbedtls/sha256.h - SHA-256 for host builds without mbedTLS headers
+//
+// Only the calls made by delta_patch and the delta encoder, with the mbedTLS
+// signatures so the component sources build unchanged.
+#ifndef HOST_MBEDTLS_SHA256_H
+#define HOST_MBEDTLS_SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t total;                 // Bytes hashed so far
+    uint8_t block[64];
+} mbedtls_sha256_context;
+
+void mbedtls_sha256_init(mbedtls_sha256_context *ctx);
+void mbedtls_sha256_free(mbedtls_sha256_context *ctx);
+// is224 is ignored, only SHA-256 is implemented
+int mbedtls_sha256_starts(mbedtls_sha256_context *ctx, int is224);
+int mbedtls_sha256_update(mbedtls_sha256_context *ctx, const unsigned char *input, size_t len);
+int mbedtls_sha256_finish(mbedtls_sha256_context *ctx, unsigned char output[32]);
+int mbedtls_sha256(const unsigned char *input, size_t len, unsigned char output[32], int is224);
+
+#endif // HOST_MBEDTLS_SHA256_H
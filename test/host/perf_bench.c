@@ -0,0 +1,393 @@
+// test/host/perf_bench.c - Host benchmark of the per-frame kernels
+//
+//   perf_bench <baseline.json>            JSON report, exit 1 if a kernel allocates more
+//   perf_bench <baseline.json> --gate     also exit 1 on a timing regression
+//   perf_bench <baseline.json> --update   rewrite the baseline
+//
+// Every kernel runs on a fixed, seeded dataset: one warmup pass, then
+// BENCH_REPETITIONS timed passes, each a sample of ns per op. The median and
+// p99 of the samples are reported. Host speeds differ, so a kernel is gated
+// on its median relative to a calibration kernel timed the same way: it
+// regresses when that ratio is more than its baseline tolerance_pct above the
+// baseline ratio, and the slowdown reproduces over BENCH_CONFIRM_RUNS further
+// measurements so a burst of load from elsewhere does not fail the gate.
+#include "alloc_count.h"
+#include "test_util.h"
+#include "vo_kernels.h"
+#include "gray_sample.h"
+#include "qr_prefilter.h"
+#include "qr_render.h"
+#if HAVE_CJSON
+#include "telemetry_codec.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_REPETITIONS 101
+#define BENCH_DEFAULT_TOLERANCE_PCT 10
+#define BENCH_CONFIRM_RUNS 2
+#define BENCH_MAX_KERNELS 16
+#define QR_PLANE_WIDTH 160          // A QVGA frame at the prefilter's half resolution
+#define QR_PLANE_HEIGHT 120
+#define GRAY_BLOCK 8                // A 16x16 MCU decoded at scale 1
+
+typedef struct {
+    const char *name;
+    void (*run)(void);      // One operation
+    int iterations;         // Operations per timed pass, sized for roughly 5 ms
+} bench_t;
+
+typedef struct {
+    char name[48];
+    double median_ns;
+    double p99_ns;
+    double relative;        // median_ns over the calibration median
+    double allocs_per_op;
+    double tolerance_pct;   // Baseline only
+} bench_result_t;
+
+static volatile int sink;   // Keeps results live so nothing is optimized away
+
+// Datasets, built once by setup_datasets()
+static uint8_t vo_frame[VO_IMAGE_WIDTH * VO_IMAGE_HEIGHT];
+static feature_point_t vo_prev_features[VO_MAX_FEATURES];
+static feature_point_t vo_curr_features[VO_MAX_FEATURES];
+static int vo_matches[VO_MAX_FEATURES * 2];
+static int vo_match_count;
+static uint8_t qr_empty_plane[QR_PLANE_WIDTH * QR_PLANE_HEIGHT];
+static uint8_t qr_code_plane[QR_PLANE_WIDTH * QR_PLANE_HEIGHT];
+static uint8_t gray_block[GRAY_BLOCK * GRAY_BLOCK * 3];
+static uint8_t gray_plane[QR_PLANE_WIDTH * QR_PLANE_HEIGHT];
+#if HAVE_CJSON
+static telemetry_data_t telemetry = {
+    .battery_voltage = 11.62f, .cpu_load = 0.415f, .core_load = { 0.31f, 0.52f },
+    .min_stack_free = 812, .deadline_misses = 3,
+};
+static char telemetry_buf[TELEMETRY_JSON_MAX_LEN];
+static const char command_json[] =
+    "{\"seq\": 1842, \"source\": \"gcs\", \"params\": {\"alt\": 12.5, \"tags\": [1, 2, 3], "
+    "\"note\": \"drop \\\"here\\\"\"}, \"command_id\": 7}";
+#endif
+
+static void setup_datasets(void) {
+    uint32_t seed = 0x2545F491;
+    // Smooth gradient with scattered high-contrast blocks, like a textured floor
+    for (int y = 0; y < VO_IMAGE_HEIGHT; y++) {
+        for (int x = 0; x < VO_IMAGE_WIDTH; x++) {
+            vo_frame[y * VO_IMAGE_WIDTH + x] = (uint8_t)(60 + x + y / 2);
+        }
+    }
+    for (int i = 0; i < 40; i++) {
+        int bx = test_rand(&seed) % (VO_IMAGE_WIDTH - 4);
+        int by = test_rand(&seed) % (VO_IMAGE_HEIGHT - 4);
+        uint8_t v = (test_rand(&seed) & 1) ? 240 : 10;
+        for (int y = by; y < by + 3; y++) {
+            for (int x = bx; x < bx + 3; x++) {
+                vo_frame[y * VO_IMAGE_WIDTH + x] = v;
+            }
+        }
+    }
+    // The previous frame's features shifted by (2, 1) with a pixel of jitter
+    for (int i = 0; i < VO_MAX_FEATURES; i++) {
+        vo_prev_features[i].x = 1 + test_rand(&seed) % (VO_IMAGE_WIDTH - 2);
+        vo_prev_features[i].y = 1 + test_rand(&seed) % (VO_IMAGE_HEIGHT - 2);
+        vo_curr_features[i].x = vo_prev_features[i].x + 2 + (int)(test_rand(&seed) % 3) - 1;
+        vo_curr_features[i].y = vo_prev_features[i].y + 1 + (int)(test_rand(&seed) % 3) - 1;
+    }
+    vo_match_count = vo_match_features(vo_prev_features, VO_MAX_FEATURES, vo_curr_features, VO_MAX_FEATURES, vo_matches);
+
+    // Textured ground alone, the common case in flight, and with a pad in view
+    qr_render_background(qr_empty_plane, QR_PLANE_WIDTH, QR_PLANE_HEIGHT, 0x0BADF00D);
+    qr_render_noise(qr_empty_plane, QR_PLANE_WIDTH, QR_PLANE_HEIGHT, 6, 1);
+    memcpy(qr_code_plane, qr_empty_plane, sizeof(qr_code_plane));
+    qr_render_params_t pad = {
+        .cx = 70.0f, .cy = 55.0f, .module = 3.0f, .angle = 0.2f, .modules = 21, .dark = 40, .light = 210, .seed = 0xC0DE,
+    };
+    qr_roi_t box;
+    qr_render_code(qr_code_plane, QR_PLANE_WIDTH, QR_PLANE_HEIGHT, &pad, &box);
+
+    for (size_t i = 0; i < sizeof(gray_block); i++) {
+        gray_block[i] = (uint8_t)test_rand(&seed);
+    }
+}
+
+// Dependent integer chain: the same work on every host, used as the unit of time
+static void run_calibration(void) {
+    uint32_t x = (uint32_t)sink | 1;
+    for (int i = 0; i < 1000; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    sink += (int)x;
+}
+
+static void run_vo_detect(void) {
+    feature_point_t features[VO_MAX_FEATURES];
+    sink += vo_detect_features(vo_frame, features, VO_MAX_FEATURES);
+}
+
+static void run_vo_match(void) {
+    int matches[VO_MAX_FEATURES * 2];
+    sink += vo_match_features(vo_prev_features, VO_MAX_FEATURES, vo_curr_features, VO_MAX_FEATURES, matches);
+}
+
+static void run_vo_estimate(void) {
+    vo_motion_t motion;
+    sink += vo_estimate_motion(vo_prev_features, vo_curr_features, vo_matches, vo_match_count, &motion);
+}
+
+// The sampling half of decode_jpeg_to_grayscale for one QVGA frame; the
+// decoder itself lives in the ESP-IDF ROM and has no host build
+static void run_gray_sample_frame(void) {
+    for (int top = 0; top < QR_PLANE_HEIGHT; top += GRAY_BLOCK) {
+        for (int left = 0; left < QR_PLANE_WIDTH; left += GRAY_BLOCK) {
+            gray_sample_rgb_block(gray_plane, QR_PLANE_WIDTH, QR_PLANE_HEIGHT, gray_block, left, top, GRAY_BLOCK,
+                                  GRAY_BLOCK, QR_PLANE_WIDTH, QR_PLANE_HEIGHT);
+        }
+    }
+    sink += gray_plane[QR_PLANE_WIDTH + 1];
+}
+
+static void run_qr_prefilter_empty(void) {
+    qr_roi_t roi;
+    sink += qr_prefilter_find(qr_empty_plane, QR_PLANE_WIDTH, QR_PLANE_HEIGHT, &roi);
+}
+
+static void run_qr_prefilter_code(void) {
+    qr_roi_t roi;
+    sink += qr_prefilter_find(qr_code_plane, QR_PLANE_WIDTH, QR_PLANE_HEIGHT, &roi);
+}
+
+#if HAVE_CJSON
+static void run_telemetry_encode(void) {
+    sink += telemetry_encode(&telemetry, telemetry_buf, sizeof(telemetry_buf));
+}
+
+static void run_command_decode(void) {
+    command_t command;
+    sink += command_decode(command_json, sizeof(command_json) - 1, &command);
+}
+#endif
+
+static const bench_t calibration = { "calibration", run_calibration, 2000 };
+
+static const bench_t benches[] = {
+    { "vo_detect_features", run_vo_detect, 600 },
+    { "vo_match_features", run_vo_match, 2000 },
+    { "vo_estimate_motion", run_vo_estimate, 3000 },
+    { "gray_sample_frame", run_gray_sample_frame, 70 },
+    { "qr_prefilter_empty", run_qr_prefilter_empty, 120 },
+    { "qr_prefilter_code", run_qr_prefilter_code, 120 },
+#if HAVE_CJSON
+    { "telemetry_encode", run_telemetry_encode, 1200 },
+    { "command_decode", run_command_decode, 6000 },
+#endif
+};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void measure(const bench_t *bench, bench_result_t *result) {
+    double samples[BENCH_REPETITIONS];
+    for (int i = 0; i < bench->iterations; i++) {
+        bench->run();
+    }
+    unsigned long allocs_before = alloc_count();
+    for (int rep = 0; rep < BENCH_REPETITIONS; rep++) {
+        double start = now_ns();
+        for (int i = 0; i < bench->iterations; i++) {
+            bench->run();
+        }
+        samples[rep] = (now_ns() - start) / bench->iterations;
+    }
+    qsort(samples, BENCH_REPETITIONS, sizeof(samples[0]), compare_double);
+    snprintf(result->name, sizeof(result->name), "%s", bench->name);
+    result->median_ns = samples[BENCH_REPETITIONS / 2];
+    result->p99_ns = samples[(BENCH_REPETITIONS - 1) * 99 / 100];
+    result->allocs_per_op = (double)(alloc_count() - allocs_before) / ((double)BENCH_REPETITIONS * bench->iterations);
+}
+
+// Numeric field of a one-line JSON object, e.g. "median_ns": 12.5
+static bool json_number(const char *line, const char *key, double *value) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *p = strstr(line, pattern);
+    if (!p) {
+        return false;
+    }
+    char *end;
+    *value = strtod(p + strlen(pattern), &end);
+    return end != p + strlen(pattern);
+}
+
+static bool json_string(const char *line, const char *key, char *value, size_t size) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": \"", key);
+    const char *p = strstr(line, pattern);
+    if (!p) {
+        return false;
+    }
+    p += strlen(pattern);
+    const char *end = strchr(p, '"');
+    if (!end || (size_t)(end - p) >= size) {
+        return false;
+    }
+    memcpy(value, p, end - p);
+    value[end - p] = '\0';
+    return true;
+}
+
+// Reads the baseline written by save_baseline(): one kernel object per line
+static int load_baseline(const char *path, bench_result_t *baseline) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    int n = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), f) && n < BENCH_MAX_KERNELS) {
+        bench_result_t *b = &baseline[n];
+        if (!json_string(line, "name", b->name, sizeof(b->name)) || !json_number(line, "relative", &b->relative) ||
+            !json_number(line, "allocs_per_op", &b->allocs_per_op)) {
+            continue;
+        }
+        json_number(line, "median_ns", &b->median_ns);
+        json_number(line, "p99_ns", &b->p99_ns);
+        if (!json_number(line, "tolerance_pct", &b->tolerance_pct)) {
+            b->tolerance_pct = BENCH_DEFAULT_TOLERANCE_PCT;
+        }
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static const bench_result_t *find(const bench_result_t *results, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(results[i].name, name) == 0) {
+            return &results[i];
+        }
+    }
+    return NULL;
+}
+
+// Tolerances are edited by hand and survive an update
+static int save_baseline(const char *path, const bench_result_t *calib, const bench_result_t *results, int count,
+                         const bench_result_t *old, int old_count) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    fprintf(f, "{\n  \"comment\": \"perf_bench baseline, regenerate with perf_bench <this file> --update on a Release "
+               "build. relative is the median over the calibration median; tolerance_pct is per kernel.\",\n");
+    fprintf(f, "  \"calibration_ns\": %.1f,\n  \"kernels\": [\n", calib->median_ns);
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *prev = old_count > 0 ? find(old, old_count, results[i].name) : NULL;
+        fprintf(f, "    {\"name\": \"%s\", \"median_ns\": %.1f, \"p99_ns\": %.1f, \"relative\": %.4f, "
+                   "\"allocs_per_op\": %.2f, \"tolerance_pct\": %.0f}%s\n",
+                results[i].name, results[i].median_ns, results[i].p99_ns, results[i].relative,
+                results[i].allocs_per_op, prev ? prev->tolerance_pct : (double)BENCH_DEFAULT_TOLERANCE_PCT,
+                i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return 0;
+}
+
+// Kernel and calibration are re-timed together so both see the same machine state
+static void measure_relative(const bench_t *bench, bench_result_t *result) {
+    bench_result_t calib;
+    measure(&calibration, &calib);
+    measure(bench, result);
+    result->relative = result->median_ns / calib.median_ns;
+}
+
+int main(int argc, char **argv) {
+    bool update = argc == 3 && strcmp(argv[2], "--update") == 0;
+    bool gate = argc == 3 && strcmp(argv[2], "--gate") == 0;
+    if (argc < 2 || argc > 3 || (argc == 3 && !update && !gate)) {
+        fprintf(stderr, "usage: %s <baseline.json> [--gate | --update]\n", argv[0]);
+        return 2;
+    }
+    int count = sizeof(benches) / sizeof(benches[0]);
+    bench_result_t results[BENCH_MAX_KERNELS];
+    bench_result_t baseline[BENCH_MAX_KERNELS];
+    int baseline_count = load_baseline(argv[1], baseline);
+    if (baseline_count < 0 && !update) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    setup_datasets();
+    bench_result_t calib;
+    measure(&calibration, &calib);
+    for (int i = 0; i < count; i++) {
+        measure(&benches[i], &results[i]);
+        results[i].relative = results[i].median_ns / calib.median_ns;
+    }
+    if (update) {
+        // The baseline is the best of as many measurements as a regression gets
+        for (int i = 0; i < count; i++) {
+            for (int run = 0; run < BENCH_CONFIRM_RUNS; run++) {
+                bench_result_t again;
+                measure_relative(&benches[i], &again);
+                if (again.relative < results[i].relative) {
+                    results[i] = again;
+                }
+            }
+        }
+        return save_baseline(argv[1], &calib, results, count, baseline, baseline_count);
+    }
+
+    int regressions = 0;
+    printf("{\n  \"calibration_ns\": %.1f,\n  \"gate\": %s,\n  \"kernels\": [\n", calib.median_ns,
+           gate ? "true" : "false");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *base = find(baseline, baseline_count, results[i].name);
+        const char *status = "ok";
+        double delta_pct = 0;
+        if (!base) {
+            status = "no_baseline";
+            regressions++;
+        } else {
+            delta_pct = (results[i].relative / base->relative - 1.0) * 100.0;
+            for (int run = 0; run < BENCH_CONFIRM_RUNS && gate && delta_pct > base->tolerance_pct; run++) {
+                bench_result_t again;
+                measure_relative(&benches[i], &again);
+                if (again.relative < results[i].relative) {
+                    results[i] = again;
+                    delta_pct = (results[i].relative / base->relative - 1.0) * 100.0;
+                }
+            }
+            if (results[i].allocs_per_op > base->allocs_per_op) {
+                status = "more_allocations";
+                regressions++;
+            } else if (delta_pct > base->tolerance_pct) {
+                status = gate ? "regression" : "slower";
+                regressions += gate;
+            }
+        }
+        printf("    {\"name\": \"%s\", \"median_ns\": %.1f, \"p99_ns\": %.1f, \"relative\": %.4f, "
+               "\"delta_pct\": %.1f, \"tolerance_pct\": %.0f, \"allocs_per_op\": %.2f, \"status\": \"%s\"}%s\n",
+               results[i].name, results[i].median_ns, results[i].p99_ns, results[i].relative, delta_pct,
+               base ? base->tolerance_pct : (double)BENCH_DEFAULT_TOLERANCE_PCT, results[i].allocs_per_op, status,
+               i + 1 < count ? "," : "");
+        if (strcmp(status, "ok") != 0 && strcmp(status, "slower") != 0) {
+            fprintf(stderr, "%s: %s (%+.1f%%, %.2f allocs/op)\n", results[i].name, status, delta_pct,
+                    results[i].allocs_per_op);
+        }
+    }
+    printf("  ],\n  \"regressions\": %d\n}\n", regressions);
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+// test/host/power_governor_sim.c - Energy proxy versus deadline misses of the power governor
+//
+// Replays a flight profile (phases and a sagging pack) through the governor at
+// its 500 ms evaluation period. Each step the task set of task_table.h is
+// rebuilt with the governor's periods and WCETs scaled to the chosen clock,
+// and the response-time analysis counts releases whose bound exceeds the
+// deadline as misses. Busy time is charged at the maximum clock and idle time at the
+// minimum, which is how DFS spends it. The measured busiest-core load is fed
+// back as the governor's load input for the next step. Nothing in the
+// firmware reports the phase yet, so the governor is also run without it.
+#include "test_util.h"
+#include "power_governor.h"
+#include "task_analysis.h"
+#include <string.h>
+
+#define SIM_STEP_MS 500             // GOVERNOR_PERIOD_MS
+#define SIM_CORES 2
+#define BATTERY_FULL_V 12.4f
+#define BATTERY_EMPTY_V 10.0f       // At the end of the profile
+
+#define PRO_CPU_NUM 0
+#define APP_CPU_NUM 1
+#include "task_table.h"
+
+#define TASK_INDEX(id, ...) SIM_##id,
+typedef enum { TASK_TABLE(TASK_INDEX) TASK_COUNT } sim_task_t;
+
+// The firmware task set from task_table.h, WCET budgets at 240 MHz
+#define TASK_MODEL(id, task_name, stack, prio, cpu, period, interarrival, deadline, wcet, blocking, queue) \
+    { .core = (cpu), .priority = (prio), .period_us = (period) * 1000, \
+      .min_interarrival_us = (interarrival) * 1000, .deadline_us = (deadline) * 1000, .wcet_us = (wcet), \
+      .blocking_us = (blocking) },
+#define TASK_NAME(id, task_name, ...) task_name,
+static const task_model_t nominal_tasks[TASK_COUNT] = { TASK_TABLE(TASK_MODEL) };
+static const char *const task_names[TASK_COUNT] = { TASK_TABLE(TASK_NAME) };
+
+// Pre-governor firmware: fixed rates at a fixed 240 MHz
+static const task_rates_t legacy = { .vo_period_ms = 50, .qr_period_ms = 50, .ultrasonic_period_ms = 50,
+                                     .telemetry_period_ms = 1000, .cpu_max_mhz = 240, .cpu_min_mhz = 240 };
+
+typedef struct {
+    flight_phase_t phase;
+    int seconds;
+} profile_leg_t;
+
+// A delivery sortie: spin-up, climb, cruise out, search, cruise back, land
+static const profile_leg_t sortie[] = {
+    { FLIGHT_PHASE_GROUND, 60 },
+    { FLIGHT_PHASE_HOVER, 30 },
+    { FLIGHT_PHASE_TRANSIT, 420 },
+    { FLIGHT_PHASE_HOVER, 90 },
+    { FLIGHT_PHASE_TRANSIT, 420 },
+    { FLIGHT_PHASE_LANDING, 60 },
+    { FLIGHT_PHASE_GROUND, 30 },
+};
+
+typedef enum {
+    POLICY_FIXED,           // The legacy rates
+    POLICY_GOVERNOR,
+    POLICY_GOVERNOR_NO_PHASE, // Governor with the phase never reported
+    POLICY_GOVERNOR_80MHZ,  // Governor with the clock capped, to show what misses look like
+} sim_policy_t;
+
+typedef struct {
+    double energy_mas;      // CPU charge, mA·s
+    uint32_t misses;
+    uint32_t releases;
+    uint32_t misses_by_task[TASK_COUNT];
+} sim_result_t;
+
+// ESP32-S3 supply current per core at each clock, running and idling without light sleep
+static float active_ma(int mhz) {
+    return mhz >= 240 ? 34.0f : mhz >= 160 ? 25.0f : mhz >= 80 ? 16.0f : 11.0f;
+}
+
+static float idle_ma(int mhz) {
+    return mhz >= 240 ? 14.0f : mhz >= 160 ? 11.0f : mhz >= 80 ? 8.0f : 6.0f;
+}
+
+static void simulate(sim_policy_t policy, sim_result_t *result) {
+    memset(result, 0, sizeof(*result));
+    int total_ms = 0;
+    for (size_t i = 0; i < sizeof(sortie) / sizeof(sortie[0]); i++) {
+        total_ms += sortie[i].seconds * 1000;
+    }
+
+    float core_load[SIM_CORES] = { 0 };
+    int elapsed_ms = 0;
+    for (size_t leg = 0; leg < sizeof(sortie) / sizeof(sortie[0]); leg++) {
+        for (int t = 0; t < sortie[leg].seconds * 1000; t += SIM_STEP_MS, elapsed_ms += SIM_STEP_MS) {
+            task_rates_t rates = legacy;
+            governor_input_t in = {
+                .phase = policy == POLICY_GOVERNOR_NO_PHASE ? FLIGHT_PHASE_UNKNOWN : sortie[leg].phase,
+                .battery_voltage = BATTERY_FULL_V - (BATTERY_FULL_V - BATTERY_EMPTY_V) * elapsed_ms / total_ms,
+                .core_load = { core_load[0], core_load[1] },
+            };
+            if (policy != POLICY_FIXED) {
+                power_governor_evaluate(&in, &rates);
+            }
+            if (policy == POLICY_GOVERNOR_80MHZ) {
+                rates.cpu_max_mhz = rates.cpu_max_mhz > 80 ? 80 : rates.cpu_max_mhz;
+                rates.cpu_min_mhz = rates.cpu_min_mhz > rates.cpu_max_mhz ? rates.cpu_max_mhz : rates.cpu_min_mhz;
+            }
+
+            task_model_t tasks[TASK_COUNT];
+            memcpy(tasks, nominal_tasks, sizeof(tasks));
+            tasks[SIM_visual_odometry_task].period_us = rates.vo_period_ms * 1000;
+            tasks[SIM_qr_code_task].period_us = rates.qr_period_ms * 1000;
+            tasks[SIM_ultrasonic_task].period_us = rates.ultrasonic_period_ms * 1000;
+            tasks[SIM_communication_task].period_us = rates.telemetry_period_ms * 1000;
+            for (int i = 0; i < TASK_COUNT; i++) {
+                tasks[i].wcet_us = (uint32_t)((uint64_t)tasks[i].wcet_us * 240 / rates.cpu_max_mhz);
+            }
+
+            task_bound_t bounds[TASK_COUNT];
+            task_analysis_response_times(tasks, TASK_COUNT, bounds);
+            for (int i = 0; i < TASK_COUNT; i++) {
+                // Event-driven tasks at their maximum rate
+                uint32_t releases = (uint32_t)((uint64_t)SIM_STEP_MS * 1000 / task_analysis_release_interval(&tasks[i]));
+                result->releases += releases;
+                if (!bounds[i].schedulable) {
+                    result->misses += releases;
+                    result->misses_by_task[i] += releases;
+                }
+            }
+
+            for (int core = 0; core < SIM_CORES; core++) {
+                float busy = task_analysis_core_utilization(tasks, TASK_COUNT, core);
+                busy = busy > 1.0f ? 1.0f : busy;
+                core_load[core] = busy;
+                result->energy_mas += (busy * active_ma(rates.cpu_max_mhz) + (1.0f - busy) * idle_ma(rates.cpu_min_mhz)) *
+                                      SIM_STEP_MS / 1000.0;
+            }
+        }
+    }
+}
+
+static void report(const char *name, const sim_result_t *r, const sim_result_t *fixed) {
+    printf("%-22s CPU %7.2f mAh (%+5.1f%%)  misses %5u/%u", name, r->energy_mas / 3600.0,
+           (r->energy_mas / fixed->energy_mas - 1.0) * 100.0, r->misses, r->releases);
+    for (int i = 0; i < TASK_COUNT; i++) {
+        if (r->misses_by_task[i]) {
+            printf("  %s %u", task_names[i], r->misses_by_task[i]);
+        }
+    }
+    printf("\n");
+}
+
+static bool same_rates(const task_rates_t *a, const task_rates_t *b) {
+    return a->vo_period_ms == b->vo_period_ms && a->qr_period_ms == b->qr_period_ms &&
+           a->ultrasonic_period_ms == b->ultrasonic_period_ms && a->telemetry_period_ms == b->telemetry_period_ms &&
+           a->cpu_max_mhz == b->cpu_max_mhz && a->cpu_min_mhz == b->cpu_min_mhz;
+}
+
+int main(void) {
+    // Without a phase, a full pack at moderate load runs as before the governor
+    task_rates_t rates;
+    governor_input_t startup = { .phase = FLIGHT_PHASE_UNKNOWN, .battery_voltage = 12.0f, .core_load = { 0.5f, 0.5f } };
+    power_governor_evaluate(&startup, &rates);
+    CHECK(same_rates(&rates, &legacy));
+    // A sagging pack and an idle CPU still save, but VO and ranging keep their rates
+    governor_input_t startup_low = { .phase = FLIGHT_PHASE_UNKNOWN, .battery_voltage = 10.0f, .core_load = { 0.1f, 0.1f } };
+    power_governor_evaluate(&startup_low, &rates);
+    CHECK(rates.vo_period_ms == legacy.vo_period_ms && rates.ultrasonic_period_ms == legacy.ultrasonic_period_ms);
+    CHECK(rates.qr_period_ms > legacy.qr_period_ms && rates.telemetry_period_ms > legacy.telemetry_period_ms);
+    CHECK(rates.cpu_min_mhz < legacy.cpu_min_mhz);
+    // Cruise scans for the pad as often as before
+    governor_input_t transit = { .phase = FLIGHT_PHASE_TRANSIT, .battery_voltage = 12.0f, .core_load = { 0.5f, 0.5f } };
+    power_governor_evaluate(&transit, &rates);
+    CHECK(rates.qr_period_ms == legacy.qr_period_ms && rates.vo_period_ms == legacy.vo_period_ms);
+
+    sim_result_t fixed, governor, no_phase, capped;
+    simulate(POLICY_FIXED, &fixed);
+    simulate(POLICY_GOVERNOR, &governor);
+    simulate(POLICY_GOVERNOR_NO_PHASE, &no_phase);
+    simulate(POLICY_GOVERNOR_80MHZ, &capped);
+    report("fixed 240 MHz", &fixed, &fixed);
+    report("governor", &governor, &fixed);
+    report("governor, no phase", &no_phase, &fixed);
+    report("governor, 80 MHz cap", &capped, &fixed);
+
+    // Saves energy without costing a deadline the fixed configuration meets,
+    // with or without phase reports. The ultrasonic busy-wait overloads core 1
+    // at any clock, so its tasks miss under every policy and that core stays
+    // busy, which leaves the savings to core 0 and the ground legs.
+    bool new_miss = false, capped_new_miss = false;
+    for (int i = 0; i < TASK_COUNT; i++) {
+        if (fixed.misses_by_task[i] == 0) {
+            new_miss |= governor.misses_by_task[i] > 0 || no_phase.misses_by_task[i] > 0;
+            capped_new_miss |= capped.misses_by_task[i] > 0;
+        }
+    }
+    CHECK(!new_miss);
+    CHECK(governor.energy_mas < fixed.energy_mas);
+    CHECK(no_phase.energy_mas <= fixed.energy_mas);
+    // The model does see new misses when the clock is too low for the load
+    CHECK(capped_new_miss);
+
+    return TEST_RESULT();
+}
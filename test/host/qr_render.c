@@ -0,0 +1,103 @@
+// test/host/qr_render.c
+#include "qr_render.h"
+#include "test_util.h"
+#include <math.h>
+#include <stdlib.h>
+
+static uint8_t clamp_u8(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+void qr_render_background(uint8_t *plane, int width, int height, uint32_t seed) {
+    int base = 90 + (int)(test_rand(&seed) % 80);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            plane[y * width + x] = clamp_u8(base + (x - width / 2) / 4 + (y - height / 2) / 6);
+        }
+    }
+    int patches = 20 + (int)(test_rand(&seed) % 40);
+    for (int i = 0; i < patches; i++) {
+        int w = 2 + (int)(test_rand(&seed) % 12), h = 2 + (int)(test_rand(&seed) % 12);
+        int x0 = (int)(test_rand(&seed) % width), y0 = (int)(test_rand(&seed) % height);
+        int delta = (int)(test_rand(&seed) % 121) - 60;
+        for (int y = y0; y < y0 + h && y < height; y++) {
+            for (int x = x0; x < x0 + w && x < width; x++) {
+                plane[y * width + x] = clamp_u8(plane[y * width + x] + delta);
+            }
+        }
+    }
+}
+
+// Module value at symbol coordinates (u, v), in modules from the top-left corner
+static bool module_dark(const qr_render_params_t *p, int u, int v) {
+    int n = p->modules;
+    int fu = u < 7 ? u : u - (n - 7), fv = v < 7 ? v : v - (n - 7);
+    bool in_finder = (u < 7 || u >= n - 7) && (v < 7 || v >= n - 7) && !(u >= n - 7 && v >= n - 7);
+    if (in_finder) {
+        int d = abs(fu - 3) > abs(fv - 3) ? abs(fu - 3) : abs(fv - 3);
+        return d != 2;
+    }
+    bool separator = (u == 7 || u == n - 8 || v == 7 || v == n - 8) && (u < 8 || u >= n - 8) && (v < 8 || v >= n - 8);
+    if (separator) {
+        return false;
+    }
+    uint32_t h = p->seed ^ (uint32_t)(u * 73856093) ^ (uint32_t)(v * 19349663);
+    return test_rand(&h) & 1;
+}
+
+void qr_render_code(uint8_t *plane, int width, int height, const qr_render_params_t *p, qr_roi_t *box) {
+    float c = cosf(p->angle), s = sinf(p->angle);
+    float half = (p->modules / 2.0f + 2) * p->module;    // Symbol plus a 2-module quiet zone
+    float extent = half * (fabsf(c) + fabsf(s));
+    int x0 = (int)floorf(p->cx - extent), x1 = (int)ceilf(p->cx + extent);
+    int y0 = (int)floorf(p->cy - extent), y1 = (int)ceilf(p->cy + extent);
+
+    for (int y = y0 < 0 ? 0 : y0; y <= y1 && y < height; y++) {
+        for (int x = x0 < 0 ? 0 : x0; x <= x1 && x < width; x++) {
+            int sum = 0, covered = 0;
+            for (int sy = 0; sy < 2; sy++) {
+                for (int sx = 0; sx < 2; sx++) {
+                    float dx = x + 0.25f + 0.5f * sx - p->cx, dy = y + 0.25f + 0.5f * sy - p->cy;
+                    // Into symbol coordinates, in modules from the top-left corner
+                    float u = (c * dx + s * dy) / p->module + p->modules / 2.0f;
+                    float v = (-s * dx + c * dy) / p->module + p->modules / 2.0f;
+                    if (u < -2 || v < -2 || u >= p->modules + 2 || v >= p->modules + 2) {
+                        sum += plane[y * width + x];
+                        continue;
+                    }
+                    covered = 1;
+                    bool dark = u >= 0 && v >= 0 && u < p->modules && v < p->modules && module_dark(p, (int)u, (int)v);
+                    sum += dark ? p->dark : p->light;
+                }
+            }
+            if (covered) {
+                plane[y * width + x] = (uint8_t)(sum / 4);
+            }
+        }
+    }
+
+    // Bounding box of the symbol itself, without the quiet zone
+    float body = p->modules / 2.0f * p->module * (fabsf(c) + fabsf(s));
+    box->x0 = (int)floorf(p->cx - body);
+    box->y0 = (int)floorf(p->cy - body);
+    box->width = (int)ceilf(p->cx + body) - box->x0;
+    box->height = (int)ceilf(p->cy + body) - box->y0;
+}
+
+void qr_render_noise(uint8_t *plane, int width, int height, int amplitude, uint32_t seed) {
+    if (amplitude <= 0) {
+        return;
+    }
+    for (int i = 0; i < width * height; i++) {
+        plane[i] = clamp_u8(plane[i] + (int)(test_rand(&seed) % (2 * amplitude + 1)) - amplitude);
+    }
+}
+
+void qr_render_half(const uint8_t *plane, int width, int height, uint8_t *half) {
+    for (int y = 0; y < height / 2; y++) {
+        for (int x = 0; x < width / 2; x++) {
+            const uint8_t *p = &plane[2 * y * width + 2 * x];
+            half[y * (width / 2) + x] = (uint8_t)((p[0] + p[1] + p[width] + p[width + 1] + 2) / 4);
+        }
+    }
+}
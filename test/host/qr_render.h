@@ -0,0 +1,28 @@
+// test/host/qr_render.h - Synthetic landing-pad frames for the QR tests
+#ifndef QR_RENDER_H
+#define QR_RENDER_H
+
+#include "qr_tracker.h"
+#include <stdint.h>
+
+typedef struct {
+    float cx, cy;                 // Symbol center, plane pixels
+    float module;                 // Module size, plane pixels
+    float angle;                  // Rotation, radians
+    int modules;                  // Symbol size in modules (21 for version 1)
+    uint8_t dark, light;
+    uint32_t seed;                // Data module pattern
+} qr_render_params_t;
+
+// Textured ground: a lighting gradient with scattered patches, like tarmac or grass
+void qr_render_background(uint8_t *plane, int width, int height, uint32_t seed);
+// Draws a code with its three finder patterns and quiet zone, 2x2 supersampled
+// the way the decoder's scaled IDCT averages pixels. box is the code's bounding box.
+void qr_render_code(uint8_t *plane, int width, int height, const qr_render_params_t *p, qr_roi_t *box);
+// Adds uniform sensor noise of +-amplitude
+void qr_render_noise(uint8_t *plane, int width, int height, int amplitude, uint32_t seed);
+// The width x height plane at half resolution, each pixel the mean of a 2x2
+// block as after the decoder's scaled IDCT
+void qr_render_half(const uint8_t *plane, int width, int height, uint8_t *half);
+
+#endif // QR_RENDER_H
@@ -0,0 +1,192 @@
+// test/host/qr_sequence_bench.c - QR search over recorded landing-pad approaches
+//
+// Replays fixed landing-pad sequences (ground-truth code box per frame) through
+// the QR search the task runs: tracker ROI prediction, and on full-frame scans
+// the finder prefilter over the half-resolution plane, retried on the full
+// frame when that finds nothing. Per sequence:
+//   - detection rate: visible frames on which the searched region held the code
+//   - skipped: frames the prefilter kept away from the decoder
+//   - decode area: mean searched area as a share of the frame, which is what
+//     the decoder's time per frame scales with
+//   - host us/frame for the search logic itself, rendering excluded
+// The decoder is replaced by an oracle that succeeds when the searched region
+// contains the whole code. Exits 1 when a sequence falls below its floor.
+#include "test_util.h"
+#include "qr_tracker.h"
+#include "qr_prefilter.h"
+#include "qr_render.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#define FRAME_WIDTH 320
+#define FRAME_HEIGHT 240
+#define PLANE_WIDTH (FRAME_WIDTH / 2)
+#define PLANE_HEIGHT (FRAME_HEIGHT / 2)
+#define TIMING_PASSES 10
+
+typedef struct {
+    qr_roi_t box;
+    bool visible;
+} truth_t;
+
+typedef struct {
+    const char *name;
+    int frames;
+    void (*truth)(int frame, truth_t *t);
+    int min_detection_pct;
+} sequence_t;
+
+static void set_box(truth_t *t, int cx, int cy, int size) {
+    t->box.x0 = cx - size / 2;
+    t->box.y0 = cy - size / 2;
+    t->box.width = size;
+    t->box.height = size;
+    t->visible = t->box.x0 >= 0 && t->box.y0 >= 0 && t->box.x0 + size <= FRAME_WIDTH && t->box.y0 + size <= FRAME_HEIGHT;
+}
+
+// Final approach: the pad grows in view while the drone corrects sideways
+static void descent(int f, truth_t *t) {
+    set_box(t, 160 + (int)(30 * sinf(f / 15.0f)), 120 + (int)(15 * cosf(f / 20.0f)), 40 + f);
+}
+
+// Pad sweeping across the frame during a lateral pass
+static void lateral_pass(int f, truth_t *t) {
+    set_box(t, 30 + 4 * f, 110, 48);
+}
+
+// Lateral pass with the pad occluded on two of every three frames (rotor
+// shadow, glare), so consecutive detections are three frames apart
+static void intermittent(int f, truth_t *t) {
+    set_box(t, 30 + 5 * f, 100 + f / 2, 48);
+    if (f % 3 != 0) {
+        t->visible = false;
+    }
+}
+
+// Hover over the pad with position hold jitter
+static void hover(int f, truth_t *t) {
+    uint32_t seed = 0x9E3779B9u ^ (uint32_t)f * 2654435761u;
+    int jx = (int)(test_rand(&seed) % 7) - 3;
+    int jy = (int)(test_rand(&seed) % 7) - 3;
+    set_box(t, 160 + jx, 120 + jy, 110);
+}
+
+// Transit over open ground, no pad in view
+static void cruise(int f, truth_t *t) {
+    set_box(t, 0, 0, 0);
+    t->visible = false;
+}
+
+static const sequence_t sequences[] = {
+    { "descent", 150, descent, 95 },
+    { "lateral_pass", 60, lateral_pass, 95 },
+    { "intermittent", 50, intermittent, 90 },
+    { "hover", 200, hover, 99 },
+    { "cruise", 200, cruise, 100 },
+};
+
+static uint8_t frame[FRAME_WIDTH * FRAME_HEIGHT];
+static uint8_t plane[PLANE_WIDTH * PLANE_HEIGHT];
+
+static void render_frame(int f, const truth_t *truth) {
+    qr_render_background(frame, FRAME_WIDTH, FRAME_HEIGHT, 0xA5A5u + (uint32_t)f / 8);
+    if (truth->visible) {
+        qr_render_params_t p = {
+            .cx = truth->box.x0 + truth->box.width / 2.0f,
+            .cy = truth->box.y0 + truth->box.height / 2.0f,
+            .module = truth->box.width / 21.0f,
+            .modules = 21,
+            .dark = 40,
+            .light = 210,
+            .seed = 0xC0DE,
+        };
+        qr_roi_t box;
+        qr_render_code(frame, FRAME_WIDTH, FRAME_HEIGHT, &p, &box);
+    }
+    qr_render_noise(frame, FRAME_WIDTH, FRAME_HEIGHT, 6, (uint32_t)f);
+    qr_render_half(frame, FRAME_WIDTH, FRAME_HEIGHT, plane);
+}
+
+static bool contains(const qr_roi_t *roi, const qr_roi_t *box) {
+    return box->x0 >= roi->x0 && box->y0 >= roi->y0 && box->x0 + box->width <= roi->x0 + roi->width &&
+           box->y0 + box->height <= roi->y0 + roi->height;
+}
+
+typedef struct {
+    int visible;
+    int detected;
+    int skipped;
+    double area;
+    double search_us;
+} replay_stats_t;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void replay(const sequence_t *seq, replay_stats_t *stats) {
+    qr_tracker_t tracker;
+    qr_tracker_reset(&tracker);
+    memset(stats, 0, sizeof(*stats));
+    for (int f = 0; f < seq->frames; f++) {
+        truth_t truth;
+        seq->truth(f, &truth);
+        stats->visible += truth.visible;
+        // The planes are only needed on filtered scans, but are rendered untimed
+        // up front since the tracker decides that inside the timed section
+        render_frame(f, &truth);
+
+        double start = now_us();
+        qr_roi_t roi;
+        bool searched = true;
+        if (qr_tracker_begin_frame(&tracker, FRAME_WIDTH, FRAME_HEIGHT, &roi) == QR_SCAN_FILTERED) {
+            qr_roi_t found;
+            searched = qr_prefilter_find(plane, PLANE_WIDTH, PLANE_HEIGHT, &found) > 0;
+            if (searched) {
+                roi.x0 = found.x0 * 2;
+                roi.y0 = found.y0 * 2;
+                roi.width = found.width * 2;
+                roi.height = found.height * 2;
+            } else {
+                searched = qr_prefilter_find(frame, FRAME_WIDTH, FRAME_HEIGHT, &roi) >= QR_PREFILTER_RETRY_FINDERS;
+            }
+        }
+        if (searched && truth.visible && contains(&roi, &truth.box)) {
+            stats->detected++;
+            qr_tracker_found(&tracker, &truth.box);
+        } else {
+            qr_tracker_missed(&tracker);
+        }
+        stats->search_us += now_us() - start;
+
+        if (searched) {
+            stats->area += (double)roi.width * roi.height / (FRAME_WIDTH * FRAME_HEIGHT);
+        } else {
+            stats->skipped++;
+        }
+    }
+}
+
+int main(void) {
+    int failures = 0;
+    printf("%-14s %7s %10s %9s %12s %10s\n", "sequence", "frames", "detected", "skipped", "decode area", "us/frame");
+    for (size_t i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        const sequence_t *seq = &sequences[i];
+        replay_stats_t stats;
+        double search_us = 0;
+        for (int pass = 0; pass < TIMING_PASSES; pass++) {
+            replay(seq, &stats);
+            search_us += stats.search_us;
+        }
+        double us_per_frame = search_us / ((double)TIMING_PASSES * seq->frames);
+        int detection_pct = stats.visible ? 100 * stats.detected / stats.visible : 100;
+        bool low = detection_pct < seq->min_detection_pct;
+        printf("%-14s %7d %9d%% %9d %11.1f%% %10.1f%s\n", seq->name, seq->frames, detection_pct, stats.skipped,
+               100.0 * stats.area / seq->frames, us_per_frame, low ? "  BELOW FLOOR" : "");
+        failures += low;
+    }
+    return failures ? 1 : 0;
+}
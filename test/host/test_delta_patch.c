@@ -0,0 +1,247 @@
+// test/host/test_delta_patch.c - Delta OTA encoder and streaming applier
+//
+// Patches are built with the delta_ota encoder from a synthetic firmware
+// image and an edited copy of it, then applied through memory-backed
+// partitions in chunks of different sizes. The image carries an address every
+// 16 bytes, and the rebuild relocates every one that points past the code that
+// grew, the way a linker does, so most moved bytes differ from the source. The
+// failure cases check that a wrong source image is refused before anything is
+// written to the target.
+#include "test_util.h"
+#include "delta_encode.h"
+#include "delta_patch.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define IMAGE_SIZE (256 * 1024)
+#define IMAGE_BASE 0x42000000u      // Flash-mapped instruction address of the image
+#define POINTER_STRIDE 16           // Bytes between address words, a literal pool or call target each
+
+typedef struct {
+    const uint8_t *source;
+    size_t source_size;
+    delta_buffer_t target;
+    int begin_calls;
+    uint32_t target_capacity;       // Stands in for the OTA partition size
+} mem_partitions_t;
+
+static int read_source(void *ctx, uint32_t offset, uint8_t *buf, size_t len) {
+    mem_partitions_t *p = (mem_partitions_t *)ctx;
+    if (offset + len > p->source_size) {
+        return -1;
+    }
+    memcpy(buf, p->source + offset, len);
+    return 0;
+}
+
+static int write_target(void *ctx, const uint8_t *buf, size_t len) {
+    mem_partitions_t *p = (mem_partitions_t *)ctx;
+    delta_buffer_put(&p->target, buf, len);
+    return 0;
+}
+
+static delta_status_t begin_target(void *ctx, const delta_header_t *header) {
+    mem_partitions_t *p = (mem_partitions_t *)ctx;
+    p->begin_calls++;
+    return header->target_size > p->target_capacity ? DELTA_ERR_RANGE : DELTA_OK;
+}
+
+static delta_status_t apply(const uint8_t *source, size_t source_size, const uint8_t *patch_data, size_t patch_size,
+                            size_t chunk, mem_partitions_t *parts) {
+    static delta_patch_t patch;
+    memset(parts, 0, sizeof(*parts));
+    parts->source = source;
+    parts->source_size = source_size;
+    parts->target_capacity = UINT32_MAX;
+    delta_patch_init(&patch, read_source, write_target, begin_target, parts);
+    delta_status_t status = DELTA_OK;
+    for (size_t off = 0; off < patch_size && status == DELTA_OK; off += chunk) {
+        status = delta_patch_feed(&patch, patch_data + off, patch_size - off < chunk ? patch_size - off : chunk);
+    }
+    if (status == DELTA_OK) {
+        status = delta_patch_finish(&patch);
+    }
+    delta_patch_free(&patch);
+    return status;
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void set_le32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+// Code-like bytes: a small instruction vocabulary with random operands, and
+// an address into the image every POINTER_STRIDE bytes
+static void make_source(uint8_t *image, size_t size, uint32_t seed) {
+    static const uint8_t opcodes[] = { 0x36, 0x41, 0x0c, 0x1d, 0xf0, 0x81, 0xe0, 0x08, 0x22, 0xa2 };
+    for (size_t i = 0; i < size; i++) {
+        image[i] = (i % 3 == 0) ? opcodes[test_rand(&seed) % sizeof(opcodes)] : (uint8_t)test_rand(&seed);
+    }
+    for (size_t i = POINTER_STRIDE - 4; i + 4 <= size; i += POINTER_STRIDE) {
+        set_le32(image + i, IMAGE_BASE + (test_rand(&seed) % size & ~3u));
+    }
+}
+
+// A rebuild: a function grows in the middle, everything after it moves and
+// every address pointing past it is relocated, constants change, the tail shifts
+static size_t make_target(const uint8_t *source, size_t size, uint8_t *target, uint32_t seed) {
+    size_t split = size / 3 & ~(size_t)(POINTER_STRIDE - 1);
+    size_t grow = 700;
+    memcpy(target, source, split);
+    for (size_t i = 0; i < grow; i++) {
+        target[split + i] = (uint8_t)test_rand(&seed);
+    }
+    memcpy(target + split + grow, source + split, size - split);
+    for (size_t i = POINTER_STRIDE - 4; i + 4 <= size; i += POINTER_STRIDE) {
+        uint8_t *word = target + i + (i < split ? 0 : grow);
+        uint32_t address = get_le32(source + i);
+        set_le32(word, address >= IMAGE_BASE + split ? address + (uint32_t)grow : address);
+    }
+    for (int i = 0; i < 40; i++) {
+        target[test_rand(&seed) % (size + grow)] ^= 0x5a;
+    }
+    return size + grow - 512;       // Some dropped at the end
+}
+
+static void test_round_trip(const uint8_t *source, const uint8_t *target, size_t target_size,
+                            const delta_buffer_t *patch) {
+    static const size_t chunks[] = { 1, 7, 1024, 1 << 20 };
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        mem_partitions_t parts;
+        CHECK(apply(source, IMAGE_SIZE, patch->data, patch->size, chunks[i], &parts) == DELTA_OK);
+        CHECK(parts.begin_calls == 1);
+        CHECK(parts.target.size == target_size && memcmp(parts.target.data, target, target_size) == 0);
+        free(parts.target.data);
+    }
+    // Edits are small and relocations are DIFF bytes that compress to almost
+    // nothing, so the patch is an order of magnitude smaller than the image
+    printf("patch %zu B for %zu B image (%.1f%%)\n", patch->size, target_size, 100.0 * patch->size / target_size);
+    CHECK(patch->size < target_size / 10);
+}
+
+static void test_wrong_source(const uint8_t *source, const delta_buffer_t *patch) {
+    // Same size, one byte different: the patch would still decode and write
+    // a corrupt image without the source hash
+    uint8_t *other = malloc(IMAGE_SIZE);
+    memcpy(other, source, IMAGE_SIZE);
+    other[IMAGE_SIZE / 2] ^= 1;
+    mem_partitions_t parts;
+    CHECK(apply(other, IMAGE_SIZE, patch->data, patch->size, 1024, &parts) == DELTA_ERR_SOURCE);
+    CHECK(parts.begin_calls == 0);
+    CHECK(parts.target.size == 0);
+    free(parts.target.data);
+
+    // Shorter source than the header claims
+    CHECK(apply(source, IMAGE_SIZE - 1, patch->data, patch->size, 1024, &parts) == DELTA_ERR_IO);
+    CHECK(parts.begin_calls == 0 && parts.target.size == 0);
+    free(other);
+}
+
+static void test_corrupt_patch(const uint8_t *source, const delta_buffer_t *patch) {
+    uint8_t *bad = malloc(patch->size);
+    mem_partitions_t parts;
+
+    memcpy(bad, patch->data, patch->size);
+    bad[16] ^= 1;                   // Target hash
+    CHECK(apply(source, IMAGE_SIZE, bad, patch->size, 1024, &parts) == DELTA_ERR_HASH);
+    free(parts.target.data);
+
+    CHECK(apply(source, IMAGE_SIZE, patch->data, patch->size - 1, 1024, &parts) == DELTA_ERR_INCOMPLETE);
+    free(parts.target.data);
+    CHECK(apply(source, IMAGE_SIZE, patch->data, DELTA_PATCH_HEADER_SIZE - 1, 1024, &parts) == DELTA_ERR_INCOMPLETE);
+    CHECK(parts.begin_calls == 0);
+    free(parts.target.data);
+
+    memcpy(bad, patch->data, patch->size);
+    bad[4] = 1;                     // Version 1 patches carry no source hash
+    CHECK(apply(source, IMAGE_SIZE, bad, patch->size, 1024, &parts) == DELTA_ERR_FORMAT);
+    CHECK(parts.begin_calls == 0);
+    free(parts.target.data);
+    bad[4] = 2;                     // Version 2 had no flags
+    CHECK(apply(source, IMAGE_SIZE, bad, patch->size, 1024, &parts) == DELTA_ERR_FORMAT);
+    free(parts.target.data);
+    bad[4] = DELTA_PATCH_VERSION;
+    bad[5] = 0x80;                  // Unknown flag
+    CHECK(apply(source, IMAGE_SIZE, bad, patch->size, 1024, &parts) == DELTA_ERR_FORMAT);
+    free(parts.target.data);
+
+    // Compressed commands starting with a match before any output
+    memcpy(bad, patch->data, DELTA_PATCH_HEADER_SIZE);
+    const uint8_t match[] = { 0x80, 0x05 };
+    memcpy(bad + DELTA_PATCH_HEADER_SIZE, match, sizeof(match));
+    CHECK(apply(source, IMAGE_SIZE, bad, DELTA_PATCH_HEADER_SIZE + sizeof(match), 1024, &parts) == DELTA_ERR_FORMAT);
+    CHECK(parts.target.size == 0);
+    free(parts.target.data);
+
+    // Header of the real patch, uncompressed, followed by a copy that runs
+    // past the source
+    bad[5] = 0;
+    const uint8_t copy[] = { DELTA_CMD_COPY, 0x10, 0xf0, 0xff, 0x1f };   // 16 bytes at IMAGE_SIZE - 8
+    memcpy(bad + DELTA_PATCH_HEADER_SIZE, copy, sizeof(copy));
+    CHECK(apply(source, IMAGE_SIZE, bad, DELTA_PATCH_HEADER_SIZE + sizeof(copy), 1024, &parts) == DELTA_ERR_RANGE);
+    CHECK(parts.target.size == 0);
+    free(parts.target.data);
+
+    // Unknown command tag
+    bad[DELTA_PATCH_HEADER_SIZE] = 7;
+    CHECK(apply(source, IMAGE_SIZE, bad, DELTA_PATCH_HEADER_SIZE + 1, 1024, &parts) == DELTA_ERR_FORMAT);
+    free(parts.target.data);
+    free(bad);
+}
+
+static void test_begin_refuses(const uint8_t *source, const delta_buffer_t *patch) {
+    static delta_patch_t p;
+    mem_partitions_t parts = { .source = source, .source_size = IMAGE_SIZE, .target_capacity = 1024 };
+    delta_patch_init(&p, read_source, write_target, begin_target, &parts);
+    CHECK(delta_patch_feed(&p, patch->data, patch->size) == DELTA_ERR_RANGE);
+    CHECK(parts.begin_calls == 1 && parts.target.size == 0);
+    delta_patch_free(&p);
+    free(parts.target.data);
+}
+
+int main(void) {
+    uint8_t *source = malloc(IMAGE_SIZE);
+    uint8_t *target = malloc(IMAGE_SIZE + 1024);
+    make_source(source, IMAGE_SIZE, 0x1234567);
+    size_t target_size = make_target(source, IMAGE_SIZE, target, 0xBEEF);
+    delta_buffer_t patch = delta_encode(source, IMAGE_SIZE, target, target_size);
+
+    test_round_trip(source, target, target_size, &patch);
+    test_wrong_source(source, &patch);
+    test_corrupt_patch(source, &patch);
+    test_begin_refuses(source, &patch);
+
+    // Identical images, and an empty target
+    delta_buffer_t same = delta_encode(source, IMAGE_SIZE, source, IMAGE_SIZE);
+    mem_partitions_t parts;
+    CHECK(apply(source, IMAGE_SIZE, same.data, same.size, 1024, &parts) == DELTA_OK);
+    CHECK(parts.target.size == IMAGE_SIZE && memcmp(parts.target.data, source, IMAGE_SIZE) == 0);
+    CHECK(same.size < DELTA_PATCH_HEADER_SIZE + 16);
+    free(parts.target.data);
+    // The same as a version 2 patch: one uncompressed COPY of the whole image
+    uint8_t v2[DELTA_PATCH_HEADER_SIZE + 5];
+    memcpy(v2, same.data, DELTA_PATCH_HEADER_SIZE);
+    v2[4] = 2;
+    v2[5] = 0;
+    const uint8_t copy_all[] = { DELTA_CMD_COPY, 0x80, 0x80, 0x10, 0x00 };   // IMAGE_SIZE bytes from 0
+    memcpy(v2 + DELTA_PATCH_HEADER_SIZE, copy_all, sizeof(copy_all));
+    CHECK(apply(source, IMAGE_SIZE, v2, DELTA_PATCH_HEADER_SIZE + sizeof(copy_all), 7, &parts) == DELTA_OK);
+    CHECK(parts.target.size == IMAGE_SIZE && memcmp(parts.target.data, source, IMAGE_SIZE) == 0);
+    free(parts.target.data);
+    delta_buffer_t empty = delta_encode(source, IMAGE_SIZE, target, 0);
+    CHECK(apply(source, IMAGE_SIZE, empty.data, empty.size, 1024, &parts) == DELTA_OK && parts.target.size == 0);
+    free(parts.target.data);
+
+    free(same.data);
+    free(empty.data);
+    free(patch.data);
+    free(source);
+    free(target);
+    return TEST_RESULT();
+}
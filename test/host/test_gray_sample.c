@@ -0,0 +1,51 @@
+// test/host/test_gray_sample.c
+#include "test_util.h"
+#include "gray_sample.h"
+#include <string.h>
+
+#define SRC_WIDTH 320
+#define SRC_HEIGHT 240
+#define OUT_WIDTH 80
+#define OUT_HEIGHT 60
+
+static uint8_t src_pixel(int x, int y) {
+    return (uint8_t)(x * 7 + y * 13);
+}
+
+int main(void) {
+    CHECK(gray_sample_scale(320, 240, 80, 60) == 2);
+    CHECK(gray_sample_scale(640, 480, 80, 60) == 3);
+    CHECK(gray_sample_scale(1600, 1200, 80, 60) == 3);
+    CHECK(gray_sample_scale(160, 120, 80, 60) == 1);
+    CHECK(gray_sample_scale(96, 96, 80, 60) == 0);
+    CHECK(gray_sample_scale(320, 240, 160, 120) == 1);
+    CHECK(gray_sample_scale(321, 241, 160, 120) == 1);
+
+    // Feeding a frame block by block, in odd-sized blocks, samples the same
+    // pixels as nearest-neighbour downsampling of the whole frame
+    static uint8_t gray[OUT_WIDTH * OUT_HEIGHT];
+    static uint8_t block[24 * 24 * 3];
+    memset(gray, 0, sizeof(gray));
+    for (int top = 0; top < SRC_HEIGHT; top += 24) {
+        for (int left = 0; left < SRC_WIDTH; left += 24) {
+            int w = left + 24 > SRC_WIDTH ? SRC_WIDTH - left : 24;
+            int h = top + 24 > SRC_HEIGHT ? SRC_HEIGHT - top : 24;
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    memset(&block[(y * w + x) * 3], src_pixel(left + x, top + y), 3);
+                }
+            }
+            gray_sample_rgb_block(gray, OUT_WIDTH, OUT_HEIGHT, block, left, top, w, h, SRC_WIDTH, SRC_HEIGHT);
+        }
+    }
+    int mismatches = 0;
+    for (int y = 0; y < OUT_HEIGHT; y++) {
+        for (int x = 0; x < OUT_WIDTH; x++) {
+            uint8_t expected = src_pixel(x * SRC_WIDTH / OUT_WIDTH, y * SRC_HEIGHT / OUT_HEIGHT);
+            mismatches += gray[y * OUT_WIDTH + x] != expected;
+        }
+    }
+    CHECK(mismatches == 0);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,114 @@
+// test/host/test_qr_prefilter.c - Prefilter false-negative and false-positive rates
+//
+// Runs the finder prefilter the way the QR task does over a fixed, seeded
+// dataset of QVGA frames: first on the half-resolution plane, then on the full
+// frame when that finds nothing. Codes vary in size, rotation, contrast and
+// noise over textured ground, and frames of ground alone measure false
+// positives. A code counts as found when the prefilter's region contains all of it.
+#include "test_util.h"
+#include "qr_prefilter.h"
+#include "qr_render.h"
+#include <math.h>
+#include <string.h>
+
+#define FRAME_WIDTH 320
+#define FRAME_HEIGHT 240
+#define PLANE_WIDTH (FRAME_WIDTH / 2)
+#define PLANE_HEIGHT (FRAME_HEIGHT / 2)
+#define CODE_FRAMES 600
+#define EMPTY_FRAMES 300
+#define SIZE_BUCKETS 4
+
+// Module sizes in half-resolution pixels, from 1.25 px (a 60 px code in the
+// QVGA frame) to 4 px. Below about 2.5 px an edge pixel that straddles two
+// modules turns a one-module run into one pixel, past the ratio test's
+// half-module tolerance, which is what the full-frame retry is for.
+static const float bucket_module[SIZE_BUCKETS + 1] = { 1.25f, 1.75f, 2.5f, 3.25f, 4.0f };
+// Requirement: at most 1 code in 20 of any size reaches the decoder only
+// through the forced full-frame decode every QR_FORCED_FULL_SCAN_INTERVAL frames
+#define MAX_FN_PCT 5
+#define MAX_FP_PCT 5
+
+static uint8_t frame[FRAME_WIDTH * FRAME_HEIGHT];
+static uint8_t plane[PLANE_WIDTH * PLANE_HEIGHT];
+
+static bool contains(const qr_roi_t *roi, const qr_roi_t *box) {
+    return box->x0 >= roi->x0 && box->y0 >= roi->y0 && box->x0 + box->width <= roi->x0 + roi->width &&
+           box->y0 + box->height <= roi->y0 + roi->height;
+}
+
+// The half-resolution scan, then the full frame as prefilter_frame() in
+// qr_code.c does; roi in frame pixels
+static bool prefilter(qr_roi_t *roi, bool *retried) {
+    qr_roi_t found;
+    qr_render_half(frame, FRAME_WIDTH, FRAME_HEIGHT, plane);
+    *retried = !qr_prefilter_find(plane, PLANE_WIDTH, PLANE_HEIGHT, &found);
+    if (!*retried) {
+        *roi = (qr_roi_t){ found.x0 * 2, found.y0 * 2, found.width * 2, found.height * 2 };
+        return true;
+    }
+    return qr_prefilter_find(frame, FRAME_WIDTH, FRAME_HEIGHT, roi) >= QR_PREFILTER_RETRY_FINDERS;
+}
+
+static float uniform(uint32_t *seed, float lo, float hi) {
+    return lo + (hi - lo) * (test_rand(seed) % 10000) / 10000.0f;
+}
+
+int main(void) {
+    uint32_t seed = 0x51F15EEDu;
+    int frames[SIZE_BUCKETS] = { 0 }, misses[SIZE_BUCKETS] = { 0 }, half_misses[SIZE_BUCKETS] = { 0 };
+
+    for (int i = 0; i < CODE_FRAMES; i++) {
+        int bucket = i % SIZE_BUCKETS;
+        qr_render_params_t p = {
+            .module = uniform(&seed, bucket_module[bucket], bucket_module[bucket + 1]),
+            .angle = uniform(&seed, -0.5f, 0.5f),
+            .modules = (test_rand(&seed) & 1) ? 21 : 25,
+            .dark = (uint8_t)(20 + test_rand(&seed) % 60),
+            .light = (uint8_t)(170 + test_rand(&seed) % 80),
+            .seed = test_rand(&seed),
+        };
+        float extent = (p.modules / 2.0f + 2) * p.module * (fabsf(cosf(p.angle)) + fabsf(sinf(p.angle)));
+        if (extent > PLANE_HEIGHT / 2) {
+            // Keep large rotated codes in view
+            p.module *= (PLANE_HEIGHT / 2) / extent;
+            extent = PLANE_HEIGHT / 2;
+        }
+        p.cx = uniform(&seed, extent, PLANE_WIDTH - extent) * 2;
+        p.cy = uniform(&seed, extent, PLANE_HEIGHT - extent) * 2;
+        p.module *= 2;
+
+        qr_roi_t box, roi;
+        bool retried;
+        qr_render_background(frame, FRAME_WIDTH, FRAME_HEIGHT, test_rand(&seed));
+        qr_render_code(frame, FRAME_WIDTH, FRAME_HEIGHT, &p, &box);
+        qr_render_noise(frame, FRAME_WIDTH, FRAME_HEIGHT, (int)(test_rand(&seed) % 16), test_rand(&seed));
+        frames[bucket]++;
+        bool found = prefilter(&roi, &retried) && contains(&roi, &box);
+        misses[bucket] += !found;
+        half_misses[bucket] += retried || !found;
+    }
+
+    int false_positives = 0, retries = 0;
+    for (int i = 0; i < EMPTY_FRAMES; i++) {
+        qr_roi_t roi;
+        bool retried;
+        qr_render_background(frame, FRAME_WIDTH, FRAME_HEIGHT, test_rand(&seed));
+        qr_render_noise(frame, FRAME_WIDTH, FRAME_HEIGHT, (int)(test_rand(&seed) % 16), test_rand(&seed));
+        false_positives += prefilter(&roi, &retried);
+        retries += retried;
+    }
+
+    for (int b = 0; b < SIZE_BUCKETS; b++) {
+        int fn_pct = 100 * misses[b] / frames[b];
+        printf("module %.2f-%.2f px: false negatives %d/%d (%d%%, max %d%%), %d%% at half resolution alone\n",
+               bucket_module[b], bucket_module[b + 1], misses[b], frames[b], fn_pct, MAX_FN_PCT,
+               100 * half_misses[b] / frames[b]);
+        CHECK(fn_pct <= MAX_FN_PCT);
+    }
+    int fp_pct = 100 * false_positives / EMPTY_FRAMES;
+    printf("empty frames: false positives %d/%d (%d%%, max %d%%), %d full-frame retries\n", false_positives,
+           EMPTY_FRAMES, fp_pct, MAX_FP_PCT, retries);
+    CHECK(fp_pct <= MAX_FP_PCT);
+    return TEST_RESULT();
+}
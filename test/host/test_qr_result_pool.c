@@ -0,0 +1,198 @@
+// test/host/test_qr_result_pool.c - Concurrent producer/consumer stress of the QR result pool
+//
+// Producers acquire a slot, stamp the payload with a sequence number and hand
+// the index over a bounded queue, as qr_code_task does through its FreeRTOS
+// queue. Consumers check the stamp and release the slot. An owner table flags
+// any slot handed to two holders at once, a torn payload or a lost slot, and
+// the allocator must not be called while results pass through the pool.
+#include "alloc_count.h"
+#include "test_util.h"
+#include "qr_result_pool.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#define STRESS_PRODUCERS 2
+#define STRESS_CONSUMERS 2
+#define STRESS_RESULTS_PER_PRODUCER 200000
+#define STRESS_QUEUE_LEN 5          // QR_CODE_QUEUE_LEN in main.c
+
+typedef struct {
+    int slot;
+    uint32_t seq;
+} queued_result_t;
+
+static qr_result_pool_t pool;
+static atomic_int owners[QR_RESULT_POOL_SIZE];     // Holders per slot, must never exceed 1
+static atomic_int ownership_errors;
+static atomic_int payload_errors;
+static atomic_long results_consumed;
+static atomic_long pool_exhausted;
+
+// Bounded queue standing in for the FreeRTOS one
+static queued_result_t queue[STRESS_QUEUE_LEN];
+static int queue_head, queue_count, producers_running;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_not_full = PTHREAD_COND_INITIALIZER;
+// Holds the workers until every thread exists, thread creation allocates
+static pthread_barrier_t start_barrier;
+
+static void stamp(uint8_t *data, uint32_t seq) {
+    for (int i = 0; i < QR_MAX_PAYLOAD_LEN; i++) {
+        data[i] = (uint8_t)(seq + i);
+    }
+    data[QR_MAX_PAYLOAD_LEN] = '\0';
+}
+
+static bool stamp_intact(const uint8_t *data, uint32_t seq) {
+    for (int i = 0; i < QR_MAX_PAYLOAD_LEN; i++) {
+        if (data[i] != (uint8_t)(seq + i)) {
+            return false;
+        }
+    }
+    return data[QR_MAX_PAYLOAD_LEN] == '\0';
+}
+
+static void take_ownership(int slot) {
+    if (atomic_fetch_add(&owners[slot], 1) != 0) {
+        atomic_fetch_add(&ownership_errors, 1);
+    }
+}
+
+static void give_up_ownership(int slot) {
+    if (atomic_fetch_sub(&owners[slot], 1) != 1) {
+        atomic_fetch_add(&ownership_errors, 1);
+    }
+}
+
+static void *producer(void *arg) {
+    uint32_t seq = (uint32_t)(uintptr_t)arg * STRESS_RESULTS_PER_PRODUCER;
+    pthread_barrier_wait(&start_barrier);
+    for (int n = 0; n < STRESS_RESULTS_PER_PRODUCER; n++, seq++) {
+        int slot;
+        while ((slot = qr_result_pool_acquire(&pool)) < 0) {
+            atomic_fetch_add(&pool_exhausted, 1);   // Backpressure, as the task waits for a slot
+            sched_yield();
+        }
+        take_ownership(slot);
+        stamp(qr_result_pool_data(&pool, slot), seq);
+        give_up_ownership(slot);
+
+        pthread_mutex_lock(&queue_lock);
+        while (queue_count == STRESS_QUEUE_LEN) {
+            pthread_cond_wait(&queue_not_full, &queue_lock);
+        }
+        queue[(queue_head + queue_count++) % STRESS_QUEUE_LEN] = (queued_result_t){ slot, seq };
+        pthread_cond_signal(&queue_not_empty);
+        pthread_mutex_unlock(&queue_lock);
+    }
+    pthread_mutex_lock(&queue_lock);
+    producers_running--;
+    pthread_cond_broadcast(&queue_not_empty);
+    pthread_mutex_unlock(&queue_lock);
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    uint32_t rng = 0x9E3779B9u ^ (uint32_t)(uintptr_t)arg;
+    pthread_barrier_wait(&start_barrier);
+    while (1) {
+        pthread_mutex_lock(&queue_lock);
+        while (queue_count == 0 && producers_running) {
+            pthread_cond_wait(&queue_not_empty, &queue_lock);
+        }
+        if (queue_count == 0) {
+            pthread_mutex_unlock(&queue_lock);
+            return NULL;
+        }
+        queued_result_t item = queue[queue_head];
+        queue_head = (queue_head + 1) % STRESS_QUEUE_LEN;
+        queue_count--;
+        pthread_cond_signal(&queue_not_full);
+        pthread_mutex_unlock(&queue_lock);
+
+        take_ownership(item.slot);
+        if (!stamp_intact(qr_result_pool_data(&pool, item.slot), item.seq)) {
+            atomic_fetch_add(&payload_errors, 1);
+        }
+        // Hold the slot for a while now and then, like a slow navigation cycle
+        if ((test_rand(&rng) & 15) == 0) {
+            sched_yield();
+        }
+        give_up_ownership(item.slot);
+        if (!qr_result_pool_release(&pool, item.slot)) {
+            atomic_fetch_add(&ownership_errors, 1);
+        }
+        atomic_fetch_add(&results_consumed, 1);
+    }
+}
+
+static void test_single_thread(void) {
+    qr_result_pool_init(&pool);
+    int slots[QR_RESULT_POOL_SIZE];
+    uint32_t seen = 0;
+    for (int i = 0; i < QR_RESULT_POOL_SIZE; i++) {
+        slots[i] = qr_result_pool_acquire(&pool);
+        CHECK(slots[i] >= 0 && slots[i] < QR_RESULT_POOL_SIZE && !(seen & (1u << slots[i])));
+        seen |= 1u << slots[i];
+    }
+    CHECK(qr_result_pool_acquire(&pool) == -1);
+    CHECK(!qr_result_pool_has_free(&pool));
+
+    CHECK(qr_result_pool_release(&pool, slots[3]));
+    CHECK(!qr_result_pool_release(&pool, slots[3]));       // Double release
+    CHECK(qr_result_pool_has_free(&pool));
+    CHECK(qr_result_pool_acquire(&pool) == slots[3]);
+
+    // Out-of-range slots, e.g. from a corrupted queue item
+    CHECK(qr_result_pool_data(&pool, -1) == NULL);
+    CHECK(qr_result_pool_data(&pool, QR_RESULT_POOL_SIZE) == NULL);
+    CHECK(qr_result_pool_data(&pool, 255) == NULL);
+    CHECK(qr_result_pool_data(&pool, QR_RESULT_POOL_SIZE - 1) == pool.data[QR_RESULT_POOL_SIZE - 1]);
+    CHECK(!qr_result_pool_release(&pool, -1));
+    CHECK(!qr_result_pool_release(&pool, QR_RESULT_POOL_SIZE));
+    CHECK(!qr_result_pool_has_free(&pool));
+}
+
+static void test_concurrent(void) {
+    qr_result_pool_init(&pool);
+    producers_running = STRESS_PRODUCERS;
+    pthread_t producers[STRESS_PRODUCERS], consumers[STRESS_CONSUMERS];
+    pthread_barrier_init(&start_barrier, NULL, STRESS_PRODUCERS + STRESS_CONSUMERS + 1);
+    for (int i = 0; i < STRESS_PRODUCERS; i++) {
+        pthread_create(&producers[i], NULL, producer, (void *)(uintptr_t)i);
+    }
+    for (int i = 0; i < STRESS_CONSUMERS; i++) {
+        pthread_create(&consumers[i], NULL, consumer, (void *)(uintptr_t)i);
+    }
+    unsigned long allocs_before = alloc_count();
+    pthread_barrier_wait(&start_barrier);
+    for (int i = 0; i < STRESS_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    for (int i = 0; i < STRESS_CONSUMERS; i++) {
+        pthread_join(consumers[i], NULL);
+    }
+    unsigned long allocs = alloc_count() - allocs_before;
+    pthread_barrier_destroy(&start_barrier);
+
+    printf("%ld results through %d slots, %ld acquires hit an exhausted pool\n", (long)atomic_load(&results_consumed),
+           QR_RESULT_POOL_SIZE, (long)atomic_load(&pool_exhausted));
+    CHECK(atomic_load(&results_consumed) == (long)STRESS_PRODUCERS * STRESS_RESULTS_PER_PRODUCER);
+    CHECK(atomic_load(&ownership_errors) == 0);
+    CHECK(atomic_load(&payload_errors) == 0);
+    CHECK(allocs == 0);
+    // Every slot is back in the pool
+    for (int i = 0; i < QR_RESULT_POOL_SIZE; i++) {
+        CHECK(qr_result_pool_acquire(&pool) >= 0);
+    }
+    CHECK(qr_result_pool_acquire(&pool) == -1);
+}
+
+int main(void) {
+    test_single_thread();
+    test_concurrent();
+    return TEST_RESULT();
+}
@@ -0,0 +1,145 @@
+// test/host/test_task_analysis.c - Response-time analysis and the firmware task table
+//
+// Checks task_analysis against hand-worked task sets, then runs it on the
+// task_table.h rows main.c builds its tasks from and prints every bound. The
+// ultrasonic echo busy-wait overloads its core, so only the tasks it cannot
+// delay, those above it or on the other core, must meet their deadlines.
+#include "test_util.h"
+#include "task_analysis.h"
+#include <string.h>
+
+#define PRO_CPU_NUM 0
+#define APP_CPU_NUM 1
+#include "task_table.h"
+
+#define TASK_MODEL(id, task_name, stack, prio, cpu, period, interarrival, deadline, wcet, blocking, queue) \
+    { .core = (cpu), .priority = (prio), .period_us = (period) * 1000, \
+      .min_interarrival_us = (interarrival) * 1000, .deadline_us = (deadline) * 1000, .wcet_us = (wcet), \
+      .blocking_us = (blocking) },
+#define TASK_NAME(id, task_name, ...) task_name,
+#define TASK_INDEX(id, ...) FW_##id,
+enum { TASK_TABLE(TASK_INDEX) };
+
+static const task_model_t firmware_tasks[] = { TASK_TABLE(TASK_MODEL) };
+static const char *const firmware_names[] = { TASK_TABLE(TASK_NAME) };
+#define FIRMWARE_TASKS ((int)(sizeof(firmware_tasks) / sizeof(firmware_tasks[0])))
+
+#define PERIODIC(prio, period, wcet) { .core = 0, .priority = (prio), .period_us = (period), .wcet_us = (wcet) }
+#define SUSPENDING(prio, period, wcet, blocking) \
+    { .core = 0, .priority = (prio), .period_us = (period), .wcet_us = (wcet), .blocking_us = (blocking) }
+
+static void test_textbook(void) {
+    // C = 1, 2, 3 and T = D = 4, 6, 12: R = 1, 3, 10
+    const task_model_t tasks[] = { PERIODIC(3, 4000, 1000), PERIODIC(2, 6000, 2000), PERIODIC(1, 12000, 3000) };
+    task_bound_t bounds[3];
+    task_analysis_response_times(tasks, 3, bounds);
+    CHECK(bounds[0].response_us == 1000 && bounds[0].schedulable);
+    CHECK(bounds[1].response_us == 3000 && bounds[1].schedulable);
+    CHECK(bounds[2].response_us == 10000 && bounds[2].schedulable);
+    float utilization = task_analysis_core_utilization(tasks, 3, 0);
+    CHECK(utilization > 0.833f && utilization < 0.834f);
+
+    // A tighter deadline on the lowest task fails; the bound stops at the first iterate past it
+    task_model_t tight[3];
+    memcpy(tight, tasks, sizeof(tight));
+    tight[2].deadline_us = 9000;
+    task_analysis_response_times(tight, 3, bounds);
+    CHECK(!bounds[2].schedulable && bounds[2].response_us > 9000);
+
+    // Over 100% utilization never converges within the period
+    const task_model_t overload[] = { PERIODIC(2, 1000, 600), PERIODIC(1, 2000, 900) };
+    task_analysis_response_times(overload, 2, bounds);
+    CHECK(bounds[0].schedulable && !bounds[1].schedulable);
+}
+
+static void test_interference_rules(void) {
+    task_model_t tasks[] = { PERIODIC(2, 10000, 4000), PERIODIC(2, 10000, 3000), PERIODIC(1, 10000, 2000) };
+    task_bound_t bounds[3];
+    // Equal priorities time-slice, so each sees the other
+    task_analysis_response_times(tasks, 3, bounds);
+    CHECK(bounds[0].response_us == 7000 && bounds[1].response_us == 7000);
+    CHECK(bounds[2].response_us == 9000);
+    // Another core does not interfere
+    tasks[0].core = 1;
+    task_analysis_response_times(tasks, 3, bounds);
+    CHECK(bounds[0].response_us == 4000 && bounds[1].response_us == 3000 && bounds[2].response_us == 5000);
+}
+
+static void test_sporadic(void) {
+    // An event task at the top priority, at most every 4 ms, behaves like the periodic one it replaces
+    task_model_t tasks[] = {
+        { .core = 0, .priority = 3, .min_interarrival_us = 4000, .wcet_us = 1000 },
+        PERIODIC(2, 6000, 2000),
+        PERIODIC(1, 12000, 3000),
+    };
+    task_bound_t bounds[3];
+    task_analysis_response_times(tasks, 3, bounds);
+    CHECK(bounds[0].response_us == 1000 && bounds[0].schedulable);
+    CHECK(bounds[2].response_us == 10000 && bounds[2].schedulable);
+    CHECK(task_analysis_release_interval(&tasks[0]) == 4000);
+
+    // Faster events push the low task past its deadline
+    tasks[0].min_interarrival_us = 2000;
+    task_analysis_response_times(tasks, 3, bounds);
+    CHECK(!bounds[2].schedulable);
+
+    // An event task with no declared rate cannot be bounded, and is flagged
+    tasks[0].min_interarrival_us = 0;
+    task_analysis_response_times(tasks, 3, bounds);
+    CHECK(!bounds[0].schedulable && bounds[0].response_us == UINT32_MAX);
+}
+
+static void test_blocking(void) {
+    // Suspending 1 of its own adds 1: R = 2 + 1 + ceil(R / 4) * 1 = 4
+    const task_model_t own[] = { PERIODIC(2, 4000, 1000), SUSPENDING(1, 6000, 2000, 1000) };
+    task_bound_t bounds[2];
+    task_analysis_response_times(own, 2, bounds);
+    CHECK(bounds[1].response_us == 4000 && bounds[1].schedulable);
+
+    // A higher task that suspends for 2 can run late, back to back with its
+    // next release: its jitter R - C = 2 costs the lower task a second preemption
+    task_model_t tasks[] = { PERIODIC(2, 4000, 1000), PERIODIC(1, 12000, 2000) };
+    task_analysis_response_times(tasks, 2, bounds);
+    CHECK(bounds[1].response_us == 3000);
+    tasks[0].blocking_us = 2000;
+    task_analysis_response_times(tasks, 2, bounds);
+    CHECK(bounds[0].response_us == 3000);
+    CHECK(bounds[1].response_us == 4000 && bounds[1].schedulable);
+
+    // Suspension alone can miss the deadline
+    tasks[1].blocking_us = 11000;
+    task_analysis_response_times(tasks, 2, bounds);
+    CHECK(!bounds[1].schedulable);
+}
+
+static void test_firmware_table(void) {
+    task_bound_t bounds[FIRMWARE_TASKS];
+    task_analysis_response_times(firmware_tasks, FIRMWARE_TASKS, bounds);
+    const task_model_t *busy_wait = &firmware_tasks[FW_ultrasonic_task];
+    for (int i = 0; i < FIRMWARE_TASKS; i++) {
+        const task_model_t *t = &firmware_tasks[i];
+        printf("  %-12s core %d prio %u  %s %5u ms  bound %6u us / deadline %6u us%s\n", firmware_names[i], t->core,
+               t->priority, t->period_us ? "period" : "events", task_analysis_release_interval(t) / 1000,
+               bounds[i].response_us, t->deadline_us, bounds[i].schedulable ? "" : " (!)");
+        CHECK(task_analysis_release_interval(t) > 0);
+        if (t->core != busy_wait->core || t->priority > busy_wait->priority) {
+            CHECK(bounds[i].schedulable);
+        }
+    }
+    for (int core = 0; core < 2; core++) {
+        float utilization = task_analysis_core_utilization(firmware_tasks, FIRMWARE_TASKS, core);
+        printf("  core %d worst-case utilization %.1f%%\n", core, utilization * 100.0f);
+        if (core != busy_wait->core) {
+            CHECK(utilization < 1.0f);
+        }
+    }
+}
+
+int main(void) {
+    test_textbook();
+    test_interference_rules();
+    test_sporadic();
+    test_blocking();
+    test_firmware_table();
+    return TEST_RESULT();
+}
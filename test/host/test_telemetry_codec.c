@@ -0,0 +1,51 @@
+// test/host/test_telemetry_codec.c
+#include "test_util.h"
+#include "telemetry_codec.h"
+#include <string.h>
+
+static bool decode(const char *json, command_t *command) {
+    return command_decode(json, strlen(json), command);
+}
+
+int main(void) {
+    command_t command = { 0 };
+
+    CHECK(decode("{\"command_id\": 3}", &command) && command.command_id == 3);
+    CHECK(decode(" {\"a\":{\"command_id\":1,\"b\":[{},[]]},\"s\":\"}\\\"\",\"command_id\":-12 } ", &command) &&
+          command.command_id == -12);
+    CHECK(!decode("{\"command_id\": \"3\"}", &command));
+    // cJSON semantics, which the command path has always had
+    CHECK(decode("{\"command_id\": 3.5}", &command) && command.command_id == 3);
+    CHECK(decode("{\"command_id\": 4, \"command_id\": 5}", &command) && command.command_id == 4);
+    CHECK(!decode("{\"other\": 3}", &command));
+    CHECK(!decode("{}", &command));
+    CHECK(!decode("[1, 2]", &command));
+    CHECK(!decode("{\"command_id\": 3", &command));
+    CHECK(!decode("{\"command_id\" 3}", &command));
+    CHECK(decode("{\"command_id\": 99999999999}", &command) && command.command_id == 2147483647);
+
+    // MQTT payloads are not null-terminated, the length bounds the parse
+    const char *payload = "{\"command_id\": 42}garbage";
+    CHECK(command_decode(payload, 18, &command) && command.command_id == 42);
+    CHECK(!command_decode(payload, 17, &command));
+
+    telemetry_data_t data = {
+        .battery_voltage = 11.5f, .cpu_load = 0.25f, .core_load = { 0.5f, 0.0f },
+        .min_stack_free = 640, .deadline_misses = 2,
+    };
+    char buf[TELEMETRY_JSON_MAX_LEN];
+    int len = telemetry_encode(&data, buf, sizeof(buf));
+    CHECK(len > 0 && (size_t)len == strlen(buf));
+    CHECK(strcmp(buf, "{\"battery_voltage\":11.5,\"cpu_load\":0.25,\"core0_load\":0.5,\"core1_load\":0,"
+                      "\"min_stack_free\":640,\"deadline_misses\":2}") == 0);
+    CHECK(telemetry_encode(&data, buf, 16) == -1);
+
+    // Floats print at full double precision; the longest record still fits
+    telemetry_data_t worst = {
+        .battery_voltage = -11.123457f, .cpu_load = 0.1234567f, .core_load = { 0.1234567f, 0.7654321f },
+        .min_stack_free = UINT32_MAX, .deadline_misses = UINT32_MAX,
+    };
+    CHECK(telemetry_encode(&worst, buf, sizeof(buf)) > 0);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,69 @@
+// test/host/test_zero_alloc.c - No heap use once the per-frame path is initialized
+//
+// Runs the portable part of the VO frame loop for a few hundred frames and
+// checks the allocator was never called after init. Telemetry goes through
+// cJSON, which allocates by design; perf_bench reports its allocations.
+#include "alloc_count.h"
+#include "test_util.h"
+#include "frame_arena.h"
+#include "gray_sample.h"
+#include "vo_kernels.h"
+#include <string.h>
+
+#define FRAMES 300
+#define BLOCK 16                    // MCU-sized blocks, as the JPEG decoder emits them
+#define SRC_WIDTH 160
+#define SRC_HEIGHT 120
+
+static uint8_t arena_buffer[4096];
+static frame_arena_t arena;
+static uint8_t gray_frame[VO_IMAGE_WIDTH * VO_IMAGE_HEIGHT];
+static feature_point_t prev_features[VO_MAX_FEATURES];
+static feature_point_t curr_features[VO_MAX_FEATURES];
+static int matches[VO_MAX_FEATURES * 2];
+
+static void run_frame(int frame, int *prev_count) {
+    frame_arena_reset(&arena);
+    uint8_t *block = frame_arena_alloc(&arena, BLOCK * BLOCK * 3);
+    CHECK(block != NULL);
+
+    // A checkerboard drifting one pixel per frame
+    for (int top = 0; top < SRC_HEIGHT; top += BLOCK) {
+        for (int left = 0; left < SRC_WIDTH; left += BLOCK) {
+            for (int i = 0; i < BLOCK * BLOCK; i++) {
+                int x = left + i % BLOCK + frame, y = top + i / BLOCK;
+                memset(&block[i * 3], ((x / 12 + y / 12) & 1) ? 220 : 30, 3);
+            }
+            gray_sample_rgb_block(gray_frame, VO_IMAGE_WIDTH, VO_IMAGE_HEIGHT, block, left, top, BLOCK, BLOCK,
+                                  SRC_WIDTH, SRC_HEIGHT);
+        }
+    }
+
+    int count = vo_detect_features(gray_frame, curr_features, VO_MAX_FEATURES);
+    if (*prev_count > 0 && count > 0) {
+        int match_count = vo_match_features(prev_features, *prev_count, curr_features, count, matches);
+        vo_motion_t motion;
+        vo_estimate_motion(prev_features, curr_features, matches, match_count, &motion);
+    }
+    memcpy(prev_features, curr_features, count * sizeof(feature_point_t));
+    *prev_count = count;
+}
+
+int main(void) {
+    int prev_count = 0;
+    frame_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+    // The first frame absorbs any one-time libc setup (stdio locale and the like)
+    run_frame(0, &prev_count);
+
+    unsigned long before = alloc_count();
+    for (int frame = 1; frame <= FRAMES; frame++) {
+        run_frame(frame, &prev_count);
+    }
+    unsigned long allocs = alloc_count() - before;
+    if (allocs) {
+        fprintf(stderr, "%lu heap allocation(s) over %d frames\n", allocs, FRAMES);
+    }
+    CHECK(allocs == 0);
+    CHECK(arena.high_water == BLOCK * BLOCK * 3);
+    return TEST_RESULT();
+}
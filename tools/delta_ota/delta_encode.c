@@ -0,0 +1,230 @@
+// tools/delta_ota/delta_encode.c - Delta patch encoder used by the delta_ota tool
+#include "delta_encode.h"
+#include "delta_patch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_MATCH 12             // Shorter matches cost more to encode than they save
+#define HASH_BYTES 8             // Bytes hashed to index a source position
+#define HASH_BITS 20
+#define MAX_CHAIN 64             // Candidates examined per target position
+#define DIFF_LOOKAHEAD 64        // Bytes scanned past the best approximate extension
+#define LZ_HASH_BITS 16
+#define LZ_MAX_CHAIN 32
+#define LZ_MAX_MATCH (0x7f + DELTA_LZ_MIN_MATCH)
+#define LZ_MAX_LITERALS 0x80
+
+void delta_buffer_put(delta_buffer_t *b, const uint8_t *data, size_t len) {
+    if (b->size + len > b->capacity) {
+        b->capacity = (b->size + len) * 2;
+        b->data = realloc(b->data, b->capacity);
+        if (!b->data) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    memcpy(b->data + b->size, data, len);
+    b->size += len;
+}
+
+static void put_varint(delta_buffer_t *b, uint64_t v) {
+    uint8_t byte;
+    do {
+        byte = v & 0x7f;
+        v >>= 7;
+        if (v) {
+            byte |= 0x80;
+        }
+        delta_buffer_put(b, &byte, 1);
+    } while (v);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint32_t hash_at(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return (uint32_t)((v * 0x9E3779B97F4A7C15ull) >> (64 - HASH_BITS));
+}
+
+static void emit_insert(delta_buffer_t *patch, const uint8_t *data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    uint8_t tag = DELTA_CMD_INSERT;
+    delta_buffer_put(patch, &tag, 1);
+    put_varint(patch, len);
+    delta_buffer_put(patch, data, len);
+}
+
+// COPY when the bytes match exactly, DIFF with the byte-wise differences otherwise
+static void emit_match(delta_buffer_t *patch, const uint8_t *src, const uint8_t *dst, size_t len, size_t exact,
+                       int64_t offset, int64_t *source_pos) {
+    int64_t delta = offset - *source_pos;
+    uint8_t tag = len > exact ? DELTA_CMD_DIFF : DELTA_CMD_COPY;
+    delta_buffer_put(patch, &tag, 1);
+    put_varint(patch, len);
+    put_varint(patch, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    for (size_t i = 0; tag == DELTA_CMD_DIFF && i < len; i++) {
+        uint8_t diff = (uint8_t)(dst[i] - src[offset + i]);
+        delta_buffer_put(patch, &diff, 1);
+    }
+    *source_pos = offset + len;
+}
+
+// bsdiff's forward extension: past the exact match, keep the source aligned
+// while more bytes match than not. Moved code whose addresses were relocated
+// stays one DIFF instead of breaking into short copies around each address.
+static size_t extend_approximate(const uint8_t *src, size_t src_size, const uint8_t *dst, size_t dst_size,
+                                 size_t offset, size_t exact) {
+    size_t best = exact;
+    long score = 0, best_score = 0;
+    for (size_t i = exact; offset + i < src_size && i < dst_size && i - best < DIFF_LOOKAHEAD; i++) {
+        score += src[offset + i] == dst[i] ? 1 : -1;
+        if (score > best_score) {
+            best_score = score;
+            best = i + 1;
+        }
+    }
+    return best;
+}
+
+static void put_literals(delta_buffer_t *out, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        size_t n = len < LZ_MAX_LITERALS ? len : LZ_MAX_LITERALS;
+        uint8_t control = (uint8_t)(n - 1);
+        delta_buffer_put(out, &control, 1);
+        delta_buffer_put(out, data, n);
+        data += n;
+        len -= n;
+    }
+}
+
+static uint32_t lz_hash_at(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Greedy LZ over the command stream in the format the applier inflates, with
+// matches no further back than its DELTA_LZ_WINDOW
+static void lz_compress(delta_buffer_t *out, const uint8_t *in, size_t size) {
+    int32_t *head = malloc(sizeof(int32_t) << LZ_HASH_BITS);
+    int32_t *chain = malloc(sizeof(int32_t) * (size ? size : 1));
+    memset(head, 0xff, sizeof(int32_t) << LZ_HASH_BITS);
+
+    size_t literal_start = 0;
+    size_t i = 0;
+    while (i + DELTA_LZ_MIN_MATCH <= size) {
+        uint32_t h = lz_hash_at(in + i);
+        size_t best_len = 0, best_distance = 0;
+        int steps = 0;
+        for (int32_t c = head[h]; c >= 0 && i - c <= DELTA_LZ_WINDOW && steps < LZ_MAX_CHAIN; c = chain[c], steps++) {
+            size_t len = 0;
+            size_t max = size - i < LZ_MAX_MATCH ? size - i : LZ_MAX_MATCH;
+            while (len < max && in[c + len] == in[i + len]) {
+                len++;
+            }
+            if (len > best_len) {
+                best_len = len;
+                best_distance = i - c;
+            }
+        }
+        if (best_len < DELTA_LZ_MIN_MATCH) {
+            chain[i] = head[h];
+            head[h] = (int32_t)i;
+            i++;
+            continue;
+        }
+        put_literals(out, in + literal_start, i - literal_start);
+        uint8_t control = (uint8_t)(0x80 | (best_len - DELTA_LZ_MIN_MATCH));
+        delta_buffer_put(out, &control, 1);
+        put_varint(out, best_distance);
+        for (size_t end = i + best_len; i < end; i++) {
+            if (i + DELTA_LZ_MIN_MATCH <= size) {
+                h = lz_hash_at(in + i);
+                chain[i] = head[h];
+                head[h] = (int32_t)i;
+            }
+        }
+        literal_start = i;
+    }
+    put_literals(out, in + literal_start, size - literal_start);
+    free(head);
+    free(chain);
+}
+
+// Greedy COPY/DIFF/INSERT encoding against a hash-chained index of every
+// source position, then LZ compression of the commands. Ties prefer the
+// candidate nearest the previous copy, which keeps offset deltas short when
+// code has only shifted.
+delta_buffer_t delta_encode(const uint8_t *src, size_t src_size, const uint8_t *dst, size_t dst_size) {
+    delta_buffer_t patch = {0};
+    delta_buffer_t commands = {0};
+    uint8_t header[DELTA_PATCH_HEADER_SIZE] = {0};
+    memcpy(header, DELTA_PATCH_MAGIC, 4);
+    header[4] = DELTA_PATCH_VERSION;
+    header[5] = DELTA_FLAG_LZ;
+    put_le32(header + 8, src_size);
+    put_le32(header + 12, dst_size);
+    mbedtls_sha256(dst, dst_size, header + 16, 0);
+    mbedtls_sha256(src, src_size, header + 48, 0);
+    delta_buffer_put(&patch, header, sizeof(header));
+
+    int32_t *head = malloc(sizeof(int32_t) << HASH_BITS);
+    int32_t *chain = malloc(sizeof(int32_t) * (src_size ? src_size : 1));
+    memset(head, 0xff, sizeof(int32_t) << HASH_BITS);
+    for (size_t i = 0; i + HASH_BYTES <= src_size; i++) {
+        uint32_t h = hash_at(src + i);
+        chain[i] = head[h];
+        head[h] = (int32_t)i;
+    }
+
+    int64_t source_pos = 0;
+    size_t insert_start = 0;
+    size_t t = 0;
+    while (t + HASH_BYTES <= dst_size) {
+        size_t best_len = 0;
+        int64_t best_off = 0;
+        int steps = 0;
+        for (int32_t c = head[hash_at(dst + t)]; c >= 0 && steps < MAX_CHAIN; c = chain[c], steps++) {
+            size_t len = 0;
+            size_t max = src_size - c < dst_size - t ? src_size - c : dst_size - t;
+            while (len < max && src[c + len] == dst[t + len]) {
+                len++;
+            }
+            if (len > best_len || (len == best_len && llabs(c - source_pos) < llabs(best_off - source_pos))) {
+                best_len = len;
+                best_off = c;
+            }
+        }
+        if (best_len < MIN_MATCH) {
+            t++;
+            continue;
+        }
+        // Grow the match backwards into bytes that would otherwise be inserted
+        while (t > insert_start && best_off > 0 && src[best_off - 1] == dst[t - 1]) {
+            t--;
+            best_off--;
+            best_len++;
+        }
+        size_t len = extend_approximate(src, src_size, dst + t, dst_size - t, best_off, best_len);
+        emit_insert(&commands, dst + insert_start, t - insert_start);
+        emit_match(&commands, src, dst + t, len, best_len, best_off, &source_pos);
+        t += len;
+        insert_start = t;
+    }
+    emit_insert(&commands, dst + insert_start, dst_size - insert_start);
+
+    lz_compress(&patch, commands.data, commands.size);
+    free(commands.data);
+    free(head);
+    free(chain);
+    return patch;
+}
@@ -0,0 +1,19 @@
+// tools/delta_ota/delta_encode.h
+#ifndef DELTA_ENCODE_H
+#define DELTA_ENCODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} delta_buffer_t;
+
+// Appends to a growing buffer, exits on allocation failure
+void delta_buffer_put(delta_buffer_t *b, const uint8_t *data, size_t len);
+// Builds a version 3 patch, LZ-compressed, turning src into dst. The caller frees .data.
+delta_buffer_t delta_encode(const uint8_t *src, size_t src_size, const uint8_t *dst, size_t dst_size);
+
+#endif // DELTA_ENCODE_H
@@ -0,0 +1,149 @@
+// tools/delta_ota/delta_ota.c - Host tool to create and apply delta OTA patches
+//
+// Build:
+//   cc -O2 -I components/ota_update -o delta_ota tools/delta_ota/delta_ota.c
+//      tools/delta_ota/delta_encode.c components/ota_update/delta_patch.c -lmbedcrypto
+//
+//   delta_ota diff  <source.bin> <target.bin> <patch.bin>
+//   delta_ota apply <source.bin> <patch.bin> <target.bin>
+//
+// "apply" runs the same streaming applier as the device against file-backed
+// partitions and reports patch ratio and apply throughput.
+#include "delta_encode.h"
+#include "delta_patch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define APPLY_CHUNK 1024         // Patch bytes fed per call, like the HTTP download
+
+static uint8_t *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(len > 0 ? len : 1);
+    if (!data || fread(data, 1, len, f) != (size_t)len) {
+        fprintf(stderr, "%s: read failed\n", path);
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *size = len;
+    return data;
+}
+
+static int write_file(const char *path, const uint8_t *data, size_t size) {
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(data, 1, size, f) != size) {
+        perror(path);
+        if (f) {
+            fclose(f);
+        }
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+typedef struct {
+    const uint8_t *source;
+    size_t source_size;
+    delta_buffer_t target;
+} file_partitions_t;
+
+static int read_source(void *ctx, uint32_t offset, uint8_t *buf, size_t len) {
+    file_partitions_t *p = (file_partitions_t *)ctx;
+    if (offset + len > p->source_size) {
+        return -1;
+    }
+    memcpy(buf, p->source + offset, len);
+    return 0;
+}
+
+static int write_target(void *ctx, const uint8_t *buf, size_t len) {
+    file_partitions_t *p = (file_partitions_t *)ctx;
+    delta_buffer_put(&p->target, buf, len);
+    return 0;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmd_diff(const char *source_path, const char *target_path, const char *patch_path) {
+    size_t src_size, dst_size;
+    uint8_t *src = read_file(source_path, &src_size);
+    uint8_t *dst = read_file(target_path, &dst_size);
+    if (!src || !dst) {
+        return 1;
+    }
+    double start = now_seconds();
+    delta_buffer_t patch = delta_encode(src, src_size, dst, dst_size);
+    double elapsed = now_seconds() - start;
+    int ret = write_file(patch_path, patch.data, patch.size) == 0 ? 0 : 1;
+    printf("patch %zu B for %zu B target (%.1f%%, %.1fx smaller) in %.2f s\n", patch.size, dst_size,
+           100.0 * patch.size / (dst_size ? dst_size : 1), (double)dst_size / patch.size, elapsed);
+    free(patch.data);
+    free(src);
+    free(dst);
+    return ret;
+}
+
+static int cmd_apply(const char *source_path, const char *patch_path, const char *target_path) {
+    size_t patch_size;
+    file_partitions_t parts = {0};
+    uint8_t *src = read_file(source_path, &parts.source_size);
+    uint8_t *patch_data = read_file(patch_path, &patch_size);
+    if (!src || !patch_data) {
+        return 1;
+    }
+    parts.source = src;
+
+    static delta_patch_t patch;
+    delta_patch_init(&patch, read_source, write_target, NULL, &parts);
+    double start = now_seconds();
+    delta_status_t status = DELTA_OK;
+    for (size_t off = 0; off < patch_size && status == DELTA_OK; off += APPLY_CHUNK) {
+        size_t n = patch_size - off < APPLY_CHUNK ? patch_size - off : APPLY_CHUNK;
+        status = delta_patch_feed(&patch, patch_data + off, n);
+    }
+    if (status == DELTA_OK) {
+        status = delta_patch_finish(&patch);
+    }
+    double elapsed = now_seconds() - start;
+    delta_patch_free(&patch);
+
+    int ret = 1;
+    if (status != DELTA_OK) {
+        fprintf(stderr, "apply failed: %s\n", delta_status_str(status));
+    } else if (write_file(target_path, parts.target.data, parts.target.size) == 0) {
+        printf("applied %zu B patch -> %zu B image, hash verified, %.1f MB/s\n", patch_size, parts.target.size,
+               parts.target.size / (elapsed > 0 ? elapsed : 1e-9) / 1e6);
+        ret = 0;
+    }
+    free(parts.target.data);
+    free(src);
+    free(patch_data);
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 5 && strcmp(argv[1], "diff") == 0) {
+        return cmd_diff(argv[2], argv[3], argv[4]);
+    }
+    if (argc == 5 && strcmp(argv[1], "apply") == 0) {
+        return cmd_apply(argv[2], argv[3], argv[4]);
+    }
+    fprintf(stderr, "usage: %s diff <source.bin> <target.bin> <patch.bin>\n"
+                    "       %s apply <source.bin> <patch.bin> <target.bin>\n", argv[0], argv[0]);
+    return 2;
+}
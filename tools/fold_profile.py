@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+# tools/fold_profile.py - Turn resource monitor PROF log lines into folded stacks
+#
+# Usage: fold_profile.py build/hybrid_drone.elf < monitor.log > profile.folded
+#        flamegraph.pl profile.folded > profile.svg
+#
+# Each "PROF core;task;pc,pc,..." sample carries a backtrace, leaf first. Every
+# frame is symbolized with addr2line and the sample emitted root first as
+# "core;task;outer;...;leaf count", one line per distinct stack. Truncated
+# backtraces (the target keeps a few frames) simply start below main.
+import argparse
+import collections
+import re
+import subprocess
+import sys
+
+ADDR2LINE = "xtensa-esp32s3-elf-addr2line"
+PROF_LINE = re.compile(r"PROF (core\d+);([^;]*);(0x[0-9a-fA-F]+(?:,0x[0-9a-fA-F]+)*)")
+
+
+def symbolize(addr2line, elf, pcs):
+    if not pcs:
+        return {}
+    out = subprocess.run([addr2line, "-f", "-e", elf] + pcs, capture_output=True, text=True, check=True).stdout
+    lines = out.splitlines()
+    # addr2line prints function and file:line per address
+    functions = {}
+    for i, pc in enumerate(pcs):
+        name = lines[2 * i]
+        functions[pc] = name if name != "??" else pc
+    return functions
+
+
+def parse(lines):
+    samples = []
+    for m in map(PROF_LINE.search, lines):
+        if m:
+            core, task, backtrace = m.groups()
+            samples.append((core, task, backtrace.split(",")))
+    return samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fold resource monitor profiler samples into stacks")
+    parser.add_argument("elf", help="firmware ELF the samples were taken from")
+    parser.add_argument("--addr2line", default=ADDR2LINE)
+    args = parser.parse_args()
+
+    samples = parse(sys.stdin)
+    functions = symbolize(args.addr2line, args.elf, sorted({pc for _, _, pcs in samples for pc in pcs}))
+    folded = collections.Counter()
+    for core, task, pcs in samples:
+        frames = [functions[pc].replace(";", ":") for pc in reversed(pcs)]
+        folded[";".join([core, task] + frames)] += 1
+    for stack, count in sorted(folded.items()):
+        print(f"{stack} {count}")
+
+
+if __name__ == "__main__":
+    main()
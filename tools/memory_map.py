@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# tools/memory_map.py - Static memory map of a firmware build
+#
+# Usage: idf.py build && memory_map.py build/hybrid_drone.elf [--top N]
+#
+# Lists every statically allocated object (task stacks and TCBs in the
+# CONFIG_DRONE_STATIC_ALLOCATION build, queue storage, frame arenas, pools)
+# by output section, so internal RAM (.dram0.*) and PSRAM (.ext_ram.bss)
+# usage is known before the image is flashed. The boot log only repeats the
+# task and queue totals.
+import argparse
+import collections
+import re
+import subprocess
+
+OBJDUMP = "xtensa-esp32s3-elf-objdump"
+# "3fc9a2c0 l     O .dram0.bss	00000c80 vo_arena_buffer"
+SYMBOL_LINE = re.compile(r"^[0-9a-fA-F]+\s+(.{7})\s+(\S+)\s+([0-9a-fA-F]+)\s+(\S+)$")
+
+
+def static_objects(elf, objdump):
+    out = subprocess.run([objdump, "-t", elf], capture_output=True, text=True, check=True).stdout
+    sections = collections.defaultdict(list)
+    for line in out.splitlines():
+        m = SYMBOL_LINE.match(line)
+        if not m:
+            continue
+        flags, section, size, name = m.groups()
+        size = int(size, 16)
+        # RAM data objects only; code and flash rodata are covered by idf.py size
+        if "O" in flags and size and section.endswith((".bss", ".data")):
+            sections[section].append((size, name))
+    return sections
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Static memory map of a firmware ELF")
+    parser.add_argument("elf")
+    parser.add_argument("--top", type=int, default=15, help="largest objects listed per section")
+    parser.add_argument("--objdump", default=OBJDUMP)
+    args = parser.parse_args()
+
+    sections = static_objects(args.elf, args.objdump)
+    for section, objects in sorted(sections.items(), key=lambda s: -sum(size for size, _ in s[1])):
+        objects.sort(reverse=True)
+        print(f"{section:<20} {sum(size for size, _ in objects):>9} B  {len(objects)} objects")
+        for size, name in objects[:args.top]:
+            print(f"    {size:>9} B  {name}")
+
+
+if __name__ == "__main__":
+    main()